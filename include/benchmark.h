@@ -0,0 +1,80 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#include "game.h"
+#include "joystick.h"
+#include "randomizer.h"
+#include "renderer.h"
+
+#define BENCHMARK_BOARDS 8
+#define BENCHMARK_REPEAT 20 // passes over the whole corpus for each measurement
+#define BENCHMARK_ROUNDS 5 // each result is the best of this many measurements, to leave out interruptions
+#ifndef BENCHMARK_THRESHOLD
+#define BENCHMARK_THRESHOLD 10 // percent: slower than the baseline by more than this is a regression
+#endif
+#define BENCHMARK_RANDOM_COUNT 70000 // outputs drawn for each measurement
+#define BENCHMARK_BASELINE_PATH "/benchmark.json" // a previous report, on the flash filesystem
+
+// measures the Game hot paths on a fixed corpus of boards
+// the report is printed as JSON, and compared to the baseline: the report of a previous run
+// with the same CPU frequency and rules, all the other baselines are ignored
+// the corpus is public, so the unit tests check the same paths on the same boards
+class Benchmark {
+public:
+    typedef bool Board[BOARD_HEIGHT][BOARD_WIDTH];
+
+    explicit Benchmark();
+    virtual ~Benchmark();
+
+    bool run(Print* pReport, const char* pBaseline = NULL); // false if a path regressed
+
+    void generateCorpus(); // the same boards on every run
+    const Board& board(int index) const { return m_Corpus[index]; }
+    static void completeRows(Board board, int index); // completes two rows, so there is something to clear
+
+private:
+    NullRenderer m_Renderer;
+    Joystick m_Joystick;
+    Game m_Game;
+    Board m_Corpus[BENCHMARK_BOARDS];
+    uint32_t m_Random;
+
+    void load(int board);
+    void spawn(TetrominoType type, TetrominoRotation rotation, int8_t x, int8_t y);
+    uint32_t next();
+
+    uint32_t benchOverlaps();
+    uint32_t benchMove();
+    uint32_t benchRotate();
+    uint32_t benchPlace();
+    uint32_t benchClearRows();
+    uint32_t benchCompact();
+    uint32_t benchRender();
+    uint32_t benchRandom();
+    uint32_t benchPieces();
+};
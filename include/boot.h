@@ -0,0 +1,77 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+
+class Game;
+class Joystick;
+class Renderer;
+
+// boot stages, in the order the fast boot goes through them
+enum BootStage {
+    BOOT_STAGE_SETUP = 0,   // setup() entered
+    BOOT_STAGE_I2C,         // I2C bus ready
+    BOOT_STAGE_DISPLAY,     // display initialized
+    BOOT_STAGE_FIRST_FRAME, // INSERT COINS on screen
+    BOOT_STAGE_SERIAL,      // serial port ready
+    BOOT_STAGE_TASKS,       // joystick tasks created
+    BOOT_STAGE_READY,       // everything else initialized
+    BOOT_STAGE_COUNT
+};
+
+// timestamps each boot stage, from the reset of the chip
+class BootProfiler {
+public:
+    explicit BootProfiler();
+    virtual ~BootProfiler();
+
+    virtual void mark(BootStage stage);
+    void report(); // prints the stages in the order they were reached
+    bool inOrder() const; // true if the stages were reached in the fast boot order
+
+private:
+    uint32_t m_Times[BOOT_STAGE_COUNT]; // microseconds since reset
+    BootStage m_Order[BOOT_STAGE_COUNT];
+    uint8_t m_Count;
+};
+
+// an SSD1306 brought up with a single I2C transmission: the init command stream
+// for a 128x64 panel with the internal charge pump is precomputed, instead of
+// being built and sent command by command as Adafruit_SSD1306::begin() does
+class FastSSD1306 : public Adafruit_SSD1306 {
+public:
+    explicit FastSSD1306(uint8_t w, uint8_t h, TwoWire* pWire, int8_t resetPin);
+    virtual ~FastSSD1306();
+
+    bool beginFast(uint8_t address); // instead of begin(), the bus must be up already
+};
+
+// the FAST_BOOT stages of setup(), from the I2C bus to the joystick tasks:
+// the display and the first frame come first, the serial port and the tasks afterwards
+// the pins of the bus must be set already; on failure, says which step failed on the serial port
+bool fastBoot(BootProfiler* pBoot, TwoWire* pWire, FastSSD1306* pDisplay, uint8_t address, Renderer* pRenderer, Joystick* pJoystick, Game* pGame);
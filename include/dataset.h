@@ -0,0 +1,101 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#include "game.h"
+
+// dataset file layout (all integers little endian):
+//
+//   header  "TTRD", version, board width, board height, reserved, records per chunk (uint16)
+//   chunk   board column: DATASET_CHUNK_RECORDS packed boards, PACKED_BOARD_SIZE bytes each
+//           move column: DATASET_CHUNK_RECORDS moves, DATASET_MOVE_SIZE bytes each
+//           trailer: record count (uint16), DATASET_CHUNK_MARKER (uint16)
+//   chunk   ...
+//
+// chunks always have the same size, so chunk i can be found without reading the ones before it;
+// only the first "record count" slots of a chunk are meaningful
+// the trailer is written last: a chunk cut short by a power cut, then padded with zeros, has no marker
+// and holds no records
+//
+// a packed board is the board before the piece is placed, as produced by Game::packBoard
+// a move is a 17-bit field: piece:3 rotation:2 x:4 y:5 lines cleared:3
+
+#define DATASET_MAGIC "TTRD"
+#define DATASET_VERSION 2
+#define DATASET_CHUNK_RECORDS 64
+
+#define DATASET_HEADER_SIZE 10
+#define DATASET_CHUNK_TRAILER_SIZE 4
+#define DATASET_CHUNK_MARKER 0x4B43 // "CK"
+#define DATASET_MOVE_SIZE 3
+#define DATASET_CHUNK_SIZE (DATASET_CHUNK_RECORDS * (PACKED_BOARD_SIZE + DATASET_MOVE_SIZE) + DATASET_CHUNK_TRAILER_SIZE)
+
+typedef struct {
+    const uint8_t* pBoard; // PACKED_BOARD_SIZE bytes, points into the mapped file
+    TetrominoType type;
+    TetrominoRotation rotation;
+    int8_t x;
+    int8_t y;
+    uint8_t lines;
+} DatasetRecord;
+
+// streams records to any Print (a file, the serial port...)
+// only the chunk being filled is kept in memory
+class DatasetWriter {
+public:
+    explicit DatasetWriter(Print* pOut);
+    virtual ~DatasetWriter();
+
+    bool begin(size_t size = 0); // appends to an output already holding size bytes of a dataset, the header goes to an empty one
+    bool add(const uint8_t* pBoard, TetrominoType type, TetrominoRotation rotation, int8_t x, int8_t y, uint8_t lines);
+    bool flush(); // writes the chunk being filled, even if not full, and flushes the output
+
+    uint32_t records() const { return m_Records; }
+
+private:
+    Print* m_pOut;
+    uint8_t m_Chunk[DATASET_CHUNK_SIZE];
+    uint16_t m_Count; // records in the current chunk
+    uint32_t m_Records; // records written since begin()
+};
+
+// reads a dataset mapped in memory: mmap() it on a PC, or esp_partition_mmap() it on the device
+// records are never copied, boards are returned as pointers into the mapping
+class DatasetReader {
+public:
+    explicit DatasetReader(const uint8_t* pData, size_t size);
+    virtual ~DatasetReader();
+
+    bool valid() const;
+    size_t chunks() const;
+    uint16_t chunkRecords(size_t chunk) const; // 0 for a chunk cut short
+    bool record(size_t chunk, uint16_t index, DatasetRecord* pRecord) const;
+
+private:
+    const uint8_t* m_pData;
+    size_t m_Size;
+};
@@ -1,86 +1,127 @@
-/*
-TETRIS for ESP32 with SSD1306 OLED display
-
-MIT License
-
-Copyright (c) 2025 Lorenzo Monti
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-#pragma once
-#include <Arduino.h>
-#include <Adafruit_SSD1306.h>
-
-#include "joystick.h"
-#include "tetromino.h"
-
-#define PLAYSCREEN_WIDTH 64
-#define PLAYSCREEN_HEIGHT 128
-
-#define LEFT_MARGIN 2
-#define BOARD_WIDTH 10
-#define BOARD_HEIGHT 21
-
-#define BLOCK_WIDTH 6
-#define BLOCK_HEIGHT 6
-
-class Game {
-private:
-    bool m_Board[BOARD_HEIGHT][BOARD_WIDTH];
-    Joystick* m_pJoystick;
-    Adafruit_SSD1306* m_pDisplay;
-    EventGroupHandle_t m_Pressed;
-    bool m_Completed[BOARD_HEIGHT];
-
-public:
-    explicit Game(Joystick* pJoystick, Adafruit_SSD1306* pDisplay);
-    virtual ~Game();
-
-private:
-    int8_t m_TetrominoX;
-    int8_t m_TetrominoY;
-    TetrominoType m_TetrominoType;
-    TetrominoRotation m_TetrominoRotation;
-    const Tetromino* m_pTetromino;
-
-    enum RenderMode {
-        RENDER_MODE_NONE = 0,
-        RENDER_MODE_INSERT_COINS,
-        RENDER_MODE_PLAYING,
-        RENDER_MODE_GAME_OVER,
-        RENDER_MODE_COUNT
-    };
-
-    bool newTetromino();
-    bool rotateTetromino();
-    bool moveTetromino(int8_t deltaX, int8_t deltaY = 0);
-    void placeTetromino();
-    bool tetrominoOverlaps(const Tetromino* pTetromino = NULL, int8_t deltaX = 0, int8_t deltaY = 0);
-    void render(RenderMode mode = RENDER_MODE_PLAYING);
-    void clear();
-    void removeCompletedRows();
-    bool clearCompletedRows();
-    void compactBoard();
-
-public:
-    bool begin();
-    void waitCoins();
-    void playMatch();
-    void over();
-};
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#include "joystick.h"
+#include "randomizer.h"
+#include "renderer.h"
+#include "rules.h"
+#include "tetromino.h"
+
+#define LEFT_MARGIN 2
+#define BOARD_WIDTH 10
+#define BOARD_HEIGHT 21
+
+#define BLOCK_WIDTH 6
+#define BLOCK_HEIGHT 6
+#define HELD_BLOCK_WIDTH 2 // the held tetromino is drawn 2x1 per block, above the board
+
+#define PACKED_BOARD_SIZE ((BOARD_WIDTH * BOARD_HEIGHT + 7) / 8) // one bit per cell, row by row from the bottom
+
+const uint32_t FALLING_SPEED = 400; // milliseconds
+
+class DatasetWriter;
+class HintEngine;
+class PowerManager;
+class Sequencer;
+class Versus;
+
+class Game {
+private:
+    bool m_Board[BOARD_HEIGHT][BOARD_WIDTH];
+    Joystick* m_pJoystick;
+    Renderer* m_pRenderer;
+    EventGroupHandle_t m_Pressed;
+    bool m_Completed[BOARD_HEIGHT];
+    Versus* m_pVersus;
+    Sequencer* m_pSequencer;
+    DatasetWriter* m_pRecorder;
+    HintEngine* m_pHint;
+    PowerManager* m_pPower;
+    PieceGenerator m_Pieces;
+    RandomStream m_Garbage; // the holes of the garbage lines
+    bool m_bWon;
+
+public:
+    explicit Game(Joystick* pJoystick, Renderer* pRenderer);
+    virtual ~Game();
+
+    void setVersus(Versus* pVersus) { m_pVersus = pVersus; }
+    void setSequencer(Sequencer* pSequencer) { m_pSequencer = pSequencer; }
+    void setRecorder(DatasetWriter* pRecorder) { m_pRecorder = pRecorder; }
+    void setHint(HintEngine* pHint) { m_pHint = pHint; }
+    void setPower(PowerManager* pPower) { m_pPower = pPower; }
+    void setRandomizer(PieceGenerator::Mode mode) { m_Pieces.setMode(mode); }
+    void seed(uint64_t seed, uint32_t stream = 0); // same seed and stream, same pieces
+    TetrominoType nextPiece(uint8_t index = 0) const { return m_Pieces.peek(index); }
+    void packBoard(uint8_t* pData) const;
+
+private:
+    int8_t m_TetrominoX;
+    int8_t m_TetrominoY;
+    TetrominoType m_TetrominoType;
+    TetrominoRotation m_TetrominoRotation;
+    const Tetromino* m_pTetromino;
+    TetrominoType m_HeldType; // TETROMINO_COUNT if none
+    bool m_bHoldUsed; // by the falling tetromino
+
+    enum RenderMode {
+        RENDER_MODE_NONE = 0,
+        RENDER_MODE_INSERT_COINS,
+        RENDER_MODE_PLAYING,
+        RENDER_MODE_GAME_OVER,
+        RENDER_MODE_YOU_WIN,
+        RENDER_MODE_COUNT
+    };
+
+    bool newTetromino();
+    bool spawnTetromino(TetrominoType type);
+    bool holdTetromino();
+    bool rotateTetromino();
+    bool moveTetromino(int8_t deltaX, int8_t deltaY = 0);
+    void placeTetromino();
+    bool tetrominoOverlaps(const Tetromino* pTetromino = NULL, int8_t deltaX = 0, int8_t deltaY = 0);
+    void render(RenderMode mode = RENDER_MODE_PLAYING);
+    void clear();
+    uint8_t removeCompletedRows();
+    bool clearCompletedRows();
+    void compactBoard();
+    void addGarbage(uint8_t lines, uint8_t hole);
+    void requestHint();
+    void waitButton();
+
+public:
+    bool begin();
+    void showInsertCoins();
+    void waitCoins();
+    void playMatch();
+    void over();
+
+    friend class Benchmark;
+    friend class GameServer;
+    friend class GameTest; // the unit tests, see test/game_test.h
+};
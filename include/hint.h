@@ -0,0 +1,80 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+#include "game.h"
+#include "joystick.h"
+#include "tetromino.h"
+
+#define HINT_CORE 0 // the game loop runs on the other core
+#define HINT_STACK 4096
+#define HINT_PRIORITY 1
+
+typedef struct {
+    uint16_t rows[BOARD_HEIGHT]; // one bit per column
+    TetrominoType type;
+    int8_t y; // height of the falling tetromino, anything above it is out of reach
+} HintRequest;
+
+// searches the best landing spot for the falling tetromino in a worker task
+// the game task posts requests and reads results without ever taking a lock:
+// a new request cancels the search in progress, and results are published as a single atomic word
+// each result asks the joystick for a redraw, which wakes up the game task waiting for a move
+class HintEngine {
+public:
+    explicit HintEngine(Joystick* pJoystick);
+    virtual ~HintEngine();
+
+    bool begin();
+
+    // game task only
+    void request(const bool board[BOARD_HEIGHT][BOARD_WIDTH], TetrominoType type, int8_t y);
+    bool result(int8_t* pX, int8_t* pY, TetrominoRotation* pRotation) const; // false if not ready for the last request
+
+    void report();
+
+private:
+    Joystick* m_pJoystick;
+    HintRequest m_Requests[2]; // written alternately, so the one being read is never the one being written
+    std::atomic<uint32_t> m_Generation;
+    std::atomic<uint32_t> m_Result; // generation:16 rotation:2 x:4 y:5
+    TaskHandle_t m_Task;
+
+    // statistics, written by the worker only
+    volatile uint32_t m_Searches;
+    volatile uint32_t m_Cancelled;
+    volatile uint32_t m_SearchMicros; // total, completed searches only
+    volatile uint32_t m_MaxSearchMicros;
+
+    bool search();
+    bool cancelled(uint32_t generation) const;
+
+    static bool fits(const uint16_t* pRows, const Tetromino* pTetromino, int8_t x, int8_t y);
+    static int32_t evaluate(const uint16_t* pRows);
+    static void searchTask(void* pvParameters);
+};
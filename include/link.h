@@ -0,0 +1,114 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+#include <esp_now.h>
+
+#include "randomizer.h"
+
+#define LINK_MAX_FRAME 32 // bytes, well below the ESP-NOW payload limit
+#define LINK_QUEUE_LENGTH 16 // frames
+
+typedef struct {
+    uint32_t due; // millis() at which the frame may be delivered
+    uint8_t length;
+    uint8_t data[LINK_MAX_FRAME];
+} LinkFrame;
+
+// a datagram transport between two units
+// frames may be lost, but are never reordered or corrupted
+class Link {
+public:
+    explicit Link();
+    virtual ~Link();
+
+    virtual bool begin() = 0;
+
+    bool send(const uint8_t* pData, uint8_t length);
+    uint8_t receive(uint8_t* pData); // returns the frame length, 0 if nothing was received
+
+    uint32_t bytesSent() const { return m_BytesSent; }
+    uint32_t bytesReceived() const { return m_BytesReceived; }
+    uint32_t framesDropped() const { return m_FramesDropped; }
+
+protected:
+    uint32_t m_FramesDropped;
+
+    virtual bool transmit(const uint8_t* pData, uint8_t length) = 0;
+    virtual uint8_t poll(uint8_t* pData) = 0;
+
+private:
+    uint32_t m_BytesSent;
+    uint32_t m_BytesReceived;
+};
+
+// in-process stand-in for a real radio
+// a link can be connected to another instance or to itself, and can simulate latency and packet loss
+class LoopbackLink : public Link {
+public:
+    explicit LoopbackLink();
+    virtual ~LoopbackLink();
+
+    bool begin() override;
+
+    void connect(LoopbackLink* pPeer) { m_pPeer = pPeer; }
+    void setImpairment(uint32_t delay, uint8_t lossPercent, uint64_t seed = 0); // the same seed loses the same frames
+
+protected:
+    bool transmit(const uint8_t* pData, uint8_t length) override;
+    uint8_t poll(uint8_t* pData) override;
+
+private:
+    QueueHandle_t m_xFrames;
+    LoopbackLink* m_pPeer;
+    uint32_t m_Delay; // milliseconds
+    uint8_t m_LossPercent;
+    RandomStream m_Loss;
+
+    bool deliver(const LinkFrame* pFrame);
+};
+
+// broadcasts frames to any unit on the same channel using ESP-NOW
+class EspNowLink : public Link {
+public:
+    explicit EspNowLink();
+    virtual ~EspNowLink();
+
+    bool begin() override;
+
+protected:
+    bool transmit(const uint8_t* pData, uint8_t length) override;
+    uint8_t poll(uint8_t* pData) override;
+
+private:
+    static QueueHandle_t s_xFrames; // filled by the ESP-NOW receive callback
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+    static void onReceive(const esp_now_recv_info_t* pInfo, const uint8_t* pData, int length);
+#else
+    static void onReceive(const uint8_t* pMac, const uint8_t* pData, int length);
+#endif
+};
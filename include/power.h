@@ -0,0 +1,76 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#include "joystick.h"
+#include "sequencer.h"
+
+// wakeups per second allowed in each state, checked against the measured rate at run time,
+// and against simulated matches by test/test_power
+#define WAKEUP_BUDGET_ATTRACT 10
+#define WAKEUP_BUDGET_PLAYING 120
+#define WAKEUP_BUDGET_GAME_OVER 40
+
+#define POWER_SILENCE_POLL 100 // milliseconds, while waiting for the sound to end before sleeping
+#define POWER_PRESS_TIMEOUT 100 // milliseconds, for the debounce to confirm a press after a wakeup
+
+// counts the wakeups of the game tasks in each state of the game,
+// and puts the chip in light sleep while the game only waits for a button
+class PowerManager {
+public:
+    enum State {
+        STATE_ATTRACT = 0,
+        STATE_PLAYING,
+        STATE_GAME_OVER,
+        STATE_COUNT
+    };
+
+    explicit PowerManager(Joystick* pJoystick, Sequencer* pSequencer);
+    virtual ~PowerManager();
+
+    void enter(State state); // closes the measurement of the current state
+    void idle(); // light sleep until a button wakes us up
+
+    uint32_t wakeupsPerSecond() const; // in the current state, so far
+
+    void report();
+
+private:
+    Joystick* m_pJoystick;
+    Sequencer* m_pSequencer;
+
+    State m_State;
+    uint32_t m_StateStart; // millis()
+    uint32_t m_StateWakeups; // wakeups() when the state was entered
+    uint32_t m_Wakeups; // our own, while waiting for silence
+
+    uint32_t m_TotalMillis[STATE_COUNT];
+    uint32_t m_TotalWakeups[STATE_COUNT];
+    uint32_t m_SleepMillis;
+
+    uint32_t wakeups() const;
+};
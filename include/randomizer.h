@@ -0,0 +1,91 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#include "tetromino.h"
+
+#define PIECE_PREVIEW 4 // pieces known in advance
+
+// counter-based random numbers: the n-th output is a pure function of the seed, the stream and n,
+// so a stream can jump anywhere in constant time, and every game or thread can own its own stream
+// streams are Weyl sequences with distinct increments, scrambled by the SplitMix64 finalizer
+class RandomStream {
+public:
+    explicit RandomStream(uint64_t seed = 0, uint32_t stream = 0);
+
+    uint32_t next();
+    uint32_t below(uint32_t bound); // uniform in [0, bound), without modulo bias
+
+    void jump(uint64_t count) { m_Counter += count; } // same as calling next() count times
+    uint64_t position() const { return m_Counter; }
+
+    // a child stream, independent of this one and of the children with other ids
+    RandomStream split(uint32_t stream) const;
+
+private:
+    uint64_t m_Seed;
+    uint64_t m_Gamma; // odd
+    uint64_t m_Counter;
+
+    static uint64_t mix64(uint64_t z);
+    static uint64_t mixGamma(uint64_t z);
+};
+
+// the sequence of falling tetrominoes, with a preview of the next ones
+// the same seed and stream always give the same sequence
+class PieceGenerator {
+public:
+    enum Mode {
+        MODE_UNIFORM = 0, // every piece drawn independently
+        MODE_BAG, // the seven pieces shuffled, dealt, and shuffled again
+        MODE_COUNT
+    };
+
+    explicit PieceGenerator(Mode mode = MODE_UNIFORM);
+    virtual ~PieceGenerator();
+
+    void seed(uint64_t seed, uint32_t stream = 0); // restarts the sequence
+    void setMode(Mode mode); // restarts the sequence of the current seed, so the order of the calls does not matter
+
+    TetrominoType next();
+    TetrominoType peek(uint8_t index = 0) const; // index < PIECE_PREVIEW, 0 is what next() returns
+
+    Mode mode() const { return m_Mode; }
+
+private:
+    Mode m_Mode;
+    uint64_t m_Seed;
+    uint32_t m_Stream;
+    RandomStream m_Random;
+    TetrominoType m_Bag[TETROMINO_COUNT];
+    uint8_t m_BagPosition; // pieces dealt from the bag
+    TetrominoType m_Preview[PIECE_PREVIEW]; // circular
+    uint8_t m_PreviewHead;
+
+    void restart();
+    TetrominoType draw();
+};
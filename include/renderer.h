@@ -0,0 +1,133 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+
+#include "spectator.h"
+
+#define PLAYSCREEN_WIDTH 64
+#define PLAYSCREEN_HEIGHT 128
+
+// where the game draws its frames
+// the game draws on gfx() with the usual Adafruit_GFX primitives, then calls present()
+class Renderer {
+public:
+    explicit Renderer();
+    virtual ~Renderer();
+
+    virtual bool begin() { return true; }
+    virtual Adafruit_GFX* gfx() = 0; // PLAYSCREEN_WIDTH x PLAYSCREEN_HEIGHT, portrait
+    virtual void clear() = 0;
+
+    void present();
+    virtual void report();
+
+protected:
+    virtual void show() = 0;
+
+private:
+    uint32_t m_Frames;
+    uint32_t m_PresentMicros; // total time spent in show()
+};
+
+// the OLED display of the real hardware
+class SSD1306Renderer : public Renderer {
+public:
+    explicit SSD1306Renderer(Adafruit_SSD1306* pDisplay);
+    virtual ~SSD1306Renderer();
+
+    Adafruit_GFX* gfx() override { return m_pDisplay; }
+    void clear() override { m_pDisplay->clearDisplay(); }
+    void report() override;
+
+    void setSpectator(Spectator* pSpectator) { m_pSpectator = pSpectator; }
+
+protected:
+    void show() override;
+
+private:
+    Adafruit_SSD1306* m_pDisplay;
+    Spectator* m_pSpectator;
+};
+
+// base for the backends drawing in memory
+class CanvasRenderer : public Renderer {
+public:
+    explicit CanvasRenderer();
+    virtual ~CanvasRenderer();
+
+    bool begin() override;
+    Adafruit_GFX* gfx() override { return &m_Canvas; }
+    void clear() override { m_Canvas.fillScreen(0); }
+
+protected:
+    GFXcanvas1 m_Canvas;
+};
+
+// rasterizes the frames and throws them away, to measure the game drawing alone
+class NullRenderer : public CanvasRenderer {
+public:
+    explicit NullRenderer() {}
+    virtual ~NullRenderer() {}
+
+protected:
+    void show() override {}
+};
+
+// draws the frames with ANSI escape sequences, two pixel rows per text line
+class TerminalRenderer : public CanvasRenderer {
+public:
+    explicit TerminalRenderer(Print* pOut);
+    virtual ~TerminalRenderer();
+
+protected:
+    void show() override;
+
+private:
+    Print* m_pOut;
+};
+
+#define PBM_FLUSH_FRAMES 32 // frames written between two flushes, the most a power cut can lose
+
+// writes every frame as a binary PBM image (P4), one after the other
+// lit pixels are white, as on the display
+// flushed every PBM_FLUSH_FRAMES frames and by report(), at the end of each match
+class PbmRenderer : public CanvasRenderer {
+public:
+    explicit PbmRenderer(Print* pOut);
+    virtual ~PbmRenderer();
+
+    void report() override;
+
+protected:
+    void show() override;
+
+private:
+    Print* m_pOut;
+    uint8_t m_Unflushed; // frames
+};
@@ -0,0 +1,120 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#include "tetromino.h"
+
+// the rules of the game are policy types, chosen at compile time:
+// a disabled feature is a constant false or zero that the compiler folds away,
+// so it costs nothing in the hot paths of the game
+
+// rotation systems: the offsets tried, in order, when rotating from a given state
+// the rotations of the Pieces table go counterclockwise
+
+// the piece rotates in place or not at all
+struct RotationPlain {
+    static const uint8_t KICKS = 1;
+
+    static Point kick(TetrominoType type, TetrominoRotation from, uint8_t index) {
+        return {0, 0};
+    }
+};
+
+// the wall and floor kicks of the Super Rotation System, for counterclockwise rotations
+// the pieces keep the rotation centers of the Pieces table, so the kicks are the SRS ones but not every twist is
+struct RotationSrs {
+    static const uint8_t KICKS = 5;
+
+    static Point kick(TetrominoType type, TetrominoRotation from, uint8_t index) {
+        // 0->L, L->2, 2->R, R->0
+        static const Point JLSTZ[ROTATION_COUNT][KICKS] = {
+            { {0, 0}, {1, 0}, {1, 1}, {0, -2}, {1, -2} },
+            { {0, 0}, {-1, 0}, {-1, -1}, {0, 2}, {-1, 2} },
+            { {0, 0}, {-1, 0}, {-1, 1}, {0, -2}, {-1, -2} },
+            { {0, 0}, {1, 0}, {1, -1}, {0, 2}, {1, 2} }
+        };
+
+        static const Point I[ROTATION_COUNT][KICKS] = {
+            { {0, 0}, {-1, 0}, {2, 0}, {-1, 2}, {2, -1} },
+            { {0, 0}, {-2, 0}, {1, 0}, {-2, -1}, {1, 2} },
+            { {0, 0}, {1, 0}, {-2, 0}, {1, -2}, {-2, 1} },
+            { {0, 0}, {2, 0}, {-1, 0}, {2, 1}, {-1, -2} }
+        };
+
+        // the O never gets past the first test, its rotations are all the same
+        return (type == TETROMINO_I) ? I[from][index] : JLSTZ[from][index];
+    }
+};
+
+// hold: swap the falling tetromino with the one put aside, once per tetromino
+struct HoldNone {
+    static const bool ENABLED = false;
+};
+
+struct HoldOnce {
+    static const bool ENABLED = true;
+};
+
+// lock: what happens when the tetromino cannot fall any further
+struct LockImmediate {
+    static const uint32_t DELAY = 0; // milliseconds
+    static const uint8_t RESETS = 0;
+};
+
+// the tetromino can still slide or rotate for a while, every successful move restarts the delay
+struct LockDelay {
+    static const uint32_t DELAY = 500; // milliseconds
+    static const uint8_t RESETS = 15; // so a tetromino cannot be kept alive forever
+};
+
+template <class RotationPolicy, class HoldPolicy, class LockPolicy>
+struct RulePolicies {
+    typedef RotationPolicy Rotation;
+    typedef HoldPolicy Hold;
+    typedef LockPolicy Lock;
+};
+
+// the rules of this build
+#if defined(RULES_SRS)
+typedef RotationSrs RulesRotation;
+#else
+typedef RotationPlain RulesRotation;
+#endif
+
+#if defined(RULES_HOLD)
+typedef HoldOnce RulesHold;
+#else
+typedef HoldNone RulesHold;
+#endif
+
+#if defined(RULES_LOCK_DELAY)
+typedef LockDelay RulesLock;
+#else
+typedef LockImmediate RulesLock;
+#endif
+
+typedef RulePolicies<RulesRotation, RulesHold, RulesLock> Rules;
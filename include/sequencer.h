@@ -0,0 +1,114 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+
+#define PIN_BUZZER 4
+
+#define SEQUENCER_TICK 5 // milliseconds
+#define SEQUENCER_QUEUE_LENGTH 8 // commands, must be a power of two
+
+// a note event: MIDI pitch (0 = rest) and duration in sequencer ticks
+typedef struct {
+    uint8_t pitch;
+    uint8_t duration;
+} Note;
+
+typedef struct {
+    const Note* pNotes;
+    uint16_t length;
+    bool loop;
+} Track;
+
+// plays music and sound effects on a buzzer from a timer, in the background
+// the game task only posts commands, it never waits for the sound to be produced
+// the timer fires only when the pitch changes, and not at all in silence
+class Sequencer {
+public:
+    enum Command {
+        COMMAND_NONE = 0,
+        COMMAND_PLAY_MUSIC,
+        COMMAND_STOP_MUSIC,
+        COMMAND_EFFECT_LANDING,
+        COMMAND_EFFECT_LINE_CLEAR,
+        COMMAND_EFFECT_GAME_OVER,
+        COMMAND_COUNT
+    };
+
+    explicit Sequencer();
+    virtual ~Sequencer();
+
+    bool begin();
+    bool post(Command command); // never blocks: returns false if the queue is full
+
+    // renders the commands posted so far into unsigned 8-bit PCM, a square wave, instead of driving the buzzer
+    // the ticks start on the 5ms grid from the first sample, whatever the sample rate
+    // the voices belong to the timer once begin() was called: returns false then
+    bool render(uint8_t* pSamples, size_t count, uint32_t sampleRate);
+
+    bool silent() const { return m_bSilent.load(std::memory_order_acquire); }
+    uint32_t wakeups() const { return m_Wakeups; }
+
+    void report();
+
+private:
+    typedef struct {
+        const Track* pTrack;
+        uint16_t position;
+        uint8_t ticksLeft;
+    } Voice;
+
+    // single producer (game task), single consumer (timer task)
+    uint8_t m_Queue[SEQUENCER_QUEUE_LENGTH];
+    std::atomic<uint8_t> m_QueueHead;
+    std::atomic<uint8_t> m_QueueTail;
+
+    Voice m_Music;
+    Voice m_Effect;
+    uint16_t m_Frequency; // currently playing, Hz
+
+    esp_timer_handle_t m_Timer;
+    int64_t m_LastTick; // esp_timer time of the last step, microseconds
+    uint8_t m_Pending; // ticks the timer was armed for, 0 in silence
+    std::atomic<bool> m_bSilent; // no voice playing and the timer not armed
+    volatile uint32_t m_Wakeups;
+    uint32_t m_TickMicros; // total time spent in tick()
+    uint32_t m_MaxTickMicros;
+    uint32_t m_Dropped; // commands lost because the queue was full
+
+    uint16_t advance();
+    uint8_t nextChange() const;
+    void execute(Command command);
+    void kick();
+    void start(Voice* pVoice, const Track* pTrack);
+    uint8_t step(Voice* pVoice);
+    void tick();
+
+    static uint16_t frequency(uint8_t pitch);
+    static void timerCallback(void* pArg);
+};
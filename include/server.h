@@ -0,0 +1,101 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#include "game.h"
+#include "joystick.h"
+#include "randomizer.h"
+#include "renderer.h"
+
+#define SERVER_SYNC 0x5A
+#define SERVER_GAMES 64
+#define SERVER_MAX_BATCH SERVER_GAMES // entries per request
+
+#define SERVER_HEADER_SIZE 6
+#define SERVER_RESET_SIZE 10 // game, seed
+#define SERVER_STEP_SIZE 4 // game, rotation, x
+#define SERVER_OBSERVE_SIZE 2 // game
+#define SERVER_STATE_SIZE (5 + PIECE_PREVIEW + PACKED_BOARD_SIZE)
+
+#define SERVER_MAX_REQUEST (SERVER_HEADER_SIZE + SERVER_MAX_BATCH * SERVER_RESET_SIZE + 1)
+#define SERVER_MAX_RESPONSE (SERVER_HEADER_SIZE + SERVER_MAX_BATCH * SERVER_STATE_SIZE + 1)
+#define SERVER_REQUEST_BUFFER (2 * SERVER_MAX_REQUEST) // room for the next request while one is parsed
+
+// hosts headless games for bots, driven over a byte stream with a batched binary protocol
+//
+// request: SYNC, type, sequence number (uint16), entry count (uint16), entries, CRC-8
+// response: SYNC, type | 0x80, the sequence number of the request, entry count (uint16), states, CRC-8
+// integers are little endian; the CRC-8 (polynomial 0x07) covers everything from the type to the last entry
+// requests can be pipelined: they are answered in order, one response each
+//
+// RESET entry: game (uint16), seed (uint64): clears the board and deals a new sequence of pieces
+//   the same game and seed always deal the same pieces, other games deal independent sequences
+// STEP entry: game (uint16), rotation (uint8), x (int8): drops the falling tetromino with that
+//   rotation from column x at the top, then clears the completed rows and spawns the next tetromino
+// OBSERVE entry: game (uint16)
+// state: game (uint16), status, lines cleared by this step, falling tetromino, next tetrominoes
+//   (PIECE_PREVIEW bytes), packed board (one bit per cell, row by row from the bottom)
+class GameServer {
+public:
+    enum RequestType {
+        REQUEST_RESET = 1,
+        REQUEST_STEP,
+        REQUEST_OBSERVE
+    };
+
+    enum Status {
+        STATUS_OK = 0,
+        STATUS_TOPPED_OUT, // the game must be reset
+        STATUS_INVALID_GAME,
+        STATUS_INVALID_PLACEMENT // the tetromino does not fit at the top in that column, nothing changed
+    };
+
+    explicit GameServer(Stream* pIo);
+    virtual ~GameServer();
+
+    bool begin();
+    void poll(); // reads and answers the pending requests, waits a little if there are none
+
+private:
+    Stream* m_pIo;
+    NullRenderer m_Renderer; // never drawn, the games need one
+    Joystick m_Joystick; // never started, the games need one
+    Game* m_Games[SERVER_GAMES];
+    bool m_ToppedOut[SERVER_GAMES];
+
+    // both buffers are reused for every request: entries are read in place, states are written in place
+    uint8_t m_Request[SERVER_REQUEST_BUFFER];
+    size_t m_Received;
+    uint8_t m_Response[SERVER_MAX_RESPONSE];
+
+    void handle(const uint8_t* pRequest);
+    uint8_t step(uint16_t game, uint8_t rotation, int8_t x, uint8_t* pLines);
+    void encodeState(uint16_t game, uint8_t status, uint8_t lines, uint8_t* pOut);
+
+    static size_t entrySize(uint8_t type);
+    static uint8_t crc8(const uint8_t* pData, size_t length);
+};
@@ -0,0 +1,78 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#define SPECTATOR_SYNC 0xA5
+#define SPECTATOR_KEYFRAME_INTERVAL 50 // frames, so viewers can join mid-stream
+
+#define SPECTATOR_PAGES 8 // SSD1306 pages, 8 pixel rows each
+#define SPECTATOR_PAGE_SIZE 128 // bytes, one per column
+#define SPECTATOR_FRAMEBUFFER_SIZE (SPECTATOR_PAGES * SPECTATOR_PAGE_SIZE)
+
+// worst case: every page sent as literals, 1 control byte per 128 bytes
+#define SPECTATOR_MAX_PAGE (SPECTATOR_PAGE_SIZE + SPECTATOR_PAGE_SIZE / 128)
+#define SPECTATOR_HEADER_SIZE 6
+#define SPECTATOR_MAX_PACKET (SPECTATOR_HEADER_SIZE + SPECTATOR_PAGES * SPECTATOR_MAX_PAGE + 1)
+
+// streams the SSD1306 framebuffer to viewers, sending only the pages that changed
+//
+// packet: SYNC, type, frame number, page mask, payload length (uint16, little endian), payload, CRC-8
+// payload: for each page in the mask, from page 0 up, the page XORed with the same page of the
+// previous packet (with zeros for a keyframe), run-length encoded:
+//   control byte 0x00-0x7F: (control + 1) literal bytes follow
+//   control byte 0x80-0xFF: the next byte is repeated (control - 0x80 + 1) times
+// pages are decoded until SPECTATOR_PAGE_SIZE bytes are produced
+// the CRC-8 (polynomial 0x07) covers everything from the type to the end of the payload
+class Spectator {
+public:
+    enum PacketType {
+        PACKET_KEYFRAME = 1,
+        PACKET_DELTA
+    };
+
+    explicit Spectator(Print* pOut);
+    virtual ~Spectator();
+
+    void frame(const uint8_t* pFramebuffer); // never waits: the frame is skipped if the output is busy
+    void report();
+
+private:
+    Print* m_pOut;
+    uint8_t m_Previous[SPECTATOR_FRAMEBUFFER_SIZE]; // as last sent
+    uint8_t m_Packet[SPECTATOR_MAX_PACKET];
+    uint8_t m_FrameNumber;
+    uint16_t m_SinceKeyframe;
+    bool m_bKeyframePending;
+
+    uint32_t m_Frames;
+    uint32_t m_Keyframes;
+    uint32_t m_Skipped;
+    uint32_t m_Bytes;
+
+    size_t encodePage(const uint8_t* pPage, const uint8_t* pReference, uint8_t* pOut);
+    static uint8_t crc8(const uint8_t* pData, size_t length);
+};
@@ -1,59 +1,59 @@
-/*
-TETRIS for ESP32 with SSD1306 OLED display
-
-MIT License
-
-Copyright (c) 2025 Lorenzo Monti
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-#pragma once
-#include <Arduino.h>
-
-enum TetrominoType {
-    TETROMINO_I = 0,
-    TETROMINO_J,
-    TETROMINO_L,
-    TETROMINO_O,
-    TETROMINO_S,
-    TETROMINO_T,
-    TETROMINO_Z,
-    TETROMINO_COUNT
-};
-
-enum TetrominoRotation {
-    ROTATION_0 = 0,
-    ROTATION_90,
-    ROTATION_180,
-    ROTATION_270,
-    ROTATION_COUNT
-};
-
-typedef struct {
-    int8_t x;
-    int8_t y;
-} Point;
-
-typedef struct {
-    Point blocks[4];
-    Point leftboundary; // for positioning hint
-    Point rightboundary; // for positioning hint
-} Tetromino;
-
-extern const Tetromino Pieces[TETROMINO_COUNT][ROTATION_COUNT];
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+enum TetrominoType {
+    TETROMINO_I = 0,
+    TETROMINO_J,
+    TETROMINO_L,
+    TETROMINO_O,
+    TETROMINO_S,
+    TETROMINO_T,
+    TETROMINO_Z,
+    TETROMINO_COUNT
+};
+
+enum TetrominoRotation {
+    ROTATION_0 = 0,
+    ROTATION_90,
+    ROTATION_180,
+    ROTATION_270,
+    ROTATION_COUNT
+};
+
+typedef struct {
+    int8_t x;
+    int8_t y;
+} Point;
+
+typedef struct {
+    Point blocks[4];
+    Point leftboundary; // for positioning hint
+    Point rightboundary; // for positioning hint
+} Tetromino;
+
+extern const Tetromino Pieces[TETROMINO_COUNT][ROTATION_COUNT];
@@ -0,0 +1,145 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#include "game.h"
+#include "link.h"
+
+#define VERSUS_HEARTBEAT_PERIOD 500 // milliseconds
+#define VERSUS_RESYNC_RETRY 250 // milliseconds
+#define VERSUS_SNAPSHOT_PERIOD 5000 // milliseconds, repairs the mirror even when every resync request is lost
+#define VERSUS_TOPPED_OUT_REPEAT 3 // the last message of a match is sent more than once
+#define VERSUS_HISTORY_LENGTH 16 // lock messages kept for replay after a snapshot
+#define VERSUS_MAX_GARBAGE 4 // lines applied per locked piece, the rest stays pending
+
+// every message starts with a header:
+// - type in the low nibble, flags in the high nibble
+// - the match id of the sender, drawn again at every reset()
+// - the match id of the receiver, as last seen by the sender (0 if none yet)
+// a new sender id means the opponent started another match: its board and garbage start over;
+// garbage and topping out only count if the receiver id is ours, so a unit never gets the garbage
+// of a match it did not play, whichever side started first
+enum VersusMessageType {
+    VERSUS_MSG_NONE = 0,
+    VERSUS_MSG_LOCK,      // seq, piece, rotation, x, y, garbage lines applied and their hole
+    VERSUS_MSG_GARBAGE,   // running total of the garbage lines sent to the opponent
+    VERSUS_MSG_HEARTBEAT, // seq, board checksum, running garbage total
+    VERSUS_MSG_RESYNC,    // ask the opponent for a snapshot
+    VERSUS_MSG_SNAPSHOT,  // seq, packed board: on request, and every VERSUS_SNAPSHOT_PERIOD
+    VERSUS_MSG_COUNT
+};
+
+#define VERSUS_FLAG_TOPPED_OUT 0x10
+
+#define VERSUS_HEADER_SIZE 3
+#define VERSUS_LOCK_SIZE (VERSUS_HEADER_SIZE + 4)
+#define VERSUS_GARBAGE_SIZE (VERSUS_HEADER_SIZE + 2)
+#define VERSUS_HEARTBEAT_SIZE (VERSUS_HEADER_SIZE + 5)
+#define VERSUS_RESYNC_SIZE VERSUS_HEADER_SIZE
+#define VERSUS_SNAPSHOT_SIZE (VERSUS_HEADER_SIZE + 1 + PACKED_BOARD_SIZE)
+
+typedef struct {
+    bool valid;
+    uint8_t seq;
+    uint32_t bits; // piece:3 rotation:2 x:4 y:5 garbage:4 hole:4
+} VersusLock;
+
+// head-to-head play between two units
+// each side sends compact deltas of its own board and keeps a mirror of the opponent board;
+// the mirror is checked against periodic checksums and rolled back to a snapshot on mismatch,
+// and to the periodic snapshots of the opponent
+class Versus {
+public:
+    explicit Versus(Link* pLink, Game* pGame);
+    virtual ~Versus();
+
+    bool begin();
+    void reset();
+    void poll();
+
+    // events from the local game
+    void pieceLocked(TetrominoType type, TetrominoRotation rotation, int8_t x, int8_t y, uint8_t garbage, uint8_t hole);
+    void linesCleared(uint8_t lines);
+    void toppedOut();
+
+    uint8_t takeGarbage(); // garbage lines received and not applied yet
+    bool opponentToppedOut() const { return m_bOpponentToppedOut; }
+    void packMirror(uint8_t* pData) const; // the opponent board as we see it, packed as Game::packBoard()
+
+    uint32_t resyncs() const { return m_ResyncCount; }
+    uint32_t maxResyncLatency() const { return m_MaxResyncLatency; } // milliseconds
+    void report();
+
+private:
+    Link* m_pLink;
+    Game* m_pGame;
+
+    // local side
+    uint8_t m_MatchId; // never 0
+    uint8_t m_LocalSeq;
+    uint16_t m_GarbageSent;
+    bool m_bToppedOut;
+    uint32_t m_LastHeartbeat;
+    uint32_t m_LastSnapshot;
+
+    // remote side
+    uint8_t m_RemoteMatchId; // 0 until a message was received
+    uint16_t m_Mirror[BOARD_HEIGHT]; // one bit per column
+    uint8_t m_RemoteSeq;
+    uint16_t m_GarbageReceived;
+    uint16_t m_PendingGarbage;
+    bool m_bOpponentToppedOut;
+    VersusLock m_History[VERSUS_HISTORY_LENGTH]; // indexed by seq
+
+    // resync
+    bool m_bResyncPending;
+    uint32_t m_ResyncRequestTime;
+    uint32_t m_ResyncSentTime;
+
+    // measurements
+    uint32_t m_StartTime;
+    uint32_t m_ResyncCount;
+    uint32_t m_LastResyncLatency;
+    uint32_t m_MaxResyncLatency;
+
+    void resetRemote();
+
+    void handle(const uint8_t* pData, uint8_t length);
+    void handleLock(const VersusLock* pLock);
+    void handleGarbage(uint16_t total);
+    void handleHeartbeat(uint8_t seq, uint16_t checksum);
+    void handleSnapshot(uint8_t seq, const uint8_t* pBoard);
+
+    void applyLock(uint32_t bits);
+    void requestResync();
+    void sendHeartbeat();
+    void sendSnapshot();
+    void sendGarbage();
+    void writeHeader(uint8_t* pMessage, VersusMessageType type) const;
+
+    static uint16_t checksum(const uint8_t* pData, size_t length);
+};
@@ -0,0 +1,184 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+// a thin stand-in for the Arduino core of the ESP32, so the game can be built and tested on a PC
+// only what the game uses is there; FreeRTOS is emulated with threads, see Native.h for the test hooks
+#include <assert.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define IRAM_ATTR
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+// time
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+// pins
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// random numbers
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+// buzzer
+void ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolution);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+uint32_t ledcWriteTone(uint8_t channel, uint32_t frequency);
+
+// cpu
+uint32_t getCpuFrequencyMhz();
+
+class EspClass {
+public:
+    uint32_t getCycleCount(); // nanoseconds on a PC, see getCpuFrequencyMhz()
+};
+
+extern EspClass ESP;
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* pBuffer, size_t size);
+    size_t write(const char* pString) { return write((const uint8_t*)pString, strlen(pString)); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const __FlashStringHelper* pString) { return print(reinterpret_cast<const char*>(pString)); }
+    size_t print(const char* pString) { return write(pString); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned int value) { return printf("%u", value); }
+    size_t println(const __FlashStringHelper* pString) { return print(pString) + println(); }
+    size_t println(const char* pString) { return print(pString) + println(); }
+    size_t println(int value) { return print(value) + println(); }
+    size_t println() { return write("\r\n"); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(uint8_t* pBuffer, size_t length);
+    size_t readBytes(char* pBuffer, size_t length) { return readBytes((uint8_t*)pBuffer, length); }
+};
+
+// standard output, nothing to read
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) {}
+    void end() {}
+    size_t setRxBufferSize(size_t size) { return size; }
+    size_t setTxBufferSize(size_t size) { return size; }
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* pBuffer, size_t size) override;
+    using Print::write;
+    int availableForWrite() override { return 4096; }
+    void flush() override;
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+// FreeRTOS, one tick per millisecond
+typedef uint32_t TickType_t;
+typedef uint32_t EventBits_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef struct NativeTask* TaskHandle_t;
+typedef struct NativeEventGroup* EventGroupHandle_t;
+typedef struct NativeQueue* QueueHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFF
+#define portTICK_PERIOD_MS 1
+#define portYIELD_FROM_ISR(...)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack, void* pParameters, UBaseType_t priority, TaskHandle_t* pTask);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack, void* pParameters, UBaseType_t priority, TaskHandle_t* pTask, BaseType_t core);
+void vTaskDelete(TaskHandle_t task); // only a task deleting itself (NULL) is supported
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void vTaskDelay(TickType_t ticks);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* pHigherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+
+EventGroupHandle_t xEventGroupCreate();
+void vEventGroupDelete(EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit, BaseType_t waitForAllBits, TickType_t ticksToWait);
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* pItem, TickType_t ticksToWait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* pItem, TickType_t ticksToWait);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* pItem, TickType_t ticksToWait);
@@ -0,0 +1,72 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+// hooks for the tests into the simulated board: time, pins, buzzer and I2C bus
+#include <Arduino.h>
+#include <vector>
+
+namespace Native {
+
+// time
+// the wall clock by default; in virtual time, millis(), micros(), the timeouts of the tasks and the esp_timer
+// only move with advance(), and the outcome of a test no longer depends on the load of the machine
+void useVirtualTime(); // before any task or timer is created
+bool virtualTime();
+// runs the tasks and timers that fall due until every task waits again, then moves the clock forward,
+// as many times as needed to get to now + microseconds; the timer callbacks run in the calling thread
+// only the tasks may block in virtual time, the thread calling advance() drives the clock
+void advance(uint64_t microseconds);
+uint64_t now(); // microseconds
+
+// pins
+void setPin(uint8_t pin, int level); // calls the interrupt handler of the pin, if attached and enabled
+bool interruptEnabled(uint8_t pin);
+int interruptType(uint8_t pin); // GPIO_INTR_...
+bool wakeupEnabled(uint8_t pin);
+// a level interrupt enabled while its level is on the pin fires again as soon as its handler returns:
+// on the chip this starves the core it runs on
+bool interruptStorm();
+uint32_t lightSleeps();
+
+// buzzer
+typedef struct {
+    uint64_t micros;
+    uint32_t frequency;
+} Tone;
+
+const std::vector<Tone>& tones(); // every ledcWriteTone() call, in order
+void clearTones();
+
+// I2C
+typedef struct {
+    uint8_t address;
+    std::vector<uint8_t> data;
+} Transmission;
+
+const std::vector<Transmission>& transmissions(); // every completed I2C write, in order
+void clearTransmissions();
+
+}
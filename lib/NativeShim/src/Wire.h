@@ -0,0 +1,56 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+// records what would go on the bus, see Native::transmissions()
+class TwoWire : public Stream {
+public:
+    bool setPins(int sda, int scl) { return true; }
+    bool begin() { return true; }
+    bool setClock(uint32_t frequency) { m_Clock = frequency; return true; }
+    uint32_t getClock() { return m_Clock; }
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true); // 0: acknowledged
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* pBuffer, size_t size) override;
+    using Print::write;
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+private:
+    uint32_t m_Clock = 100000;
+    uint8_t m_Address = 0;
+    bool m_bTransmitting = false;
+    uint8_t m_Buffer[128]; // the transmit buffer of the ESP32 core
+    size_t m_Length = 0;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,223 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <mutex>
+#include <random>
+
+#include <Wire.h>
+#include <WiFi.h>
+
+#include "Native.h"
+
+HardwareSerial Serial;
+TwoWire Wire;
+WiFiClass WiFi;
+EspClass ESP;
+
+// print
+
+size_t Print::write(const uint8_t* pBuffer, size_t size) {
+    size_t count = 0;
+
+    while (count < size && write(pBuffer[count])) {
+        count++;
+    }
+
+    return count;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[128];
+    va_list args;
+
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (length < 0) {
+        return 0;
+    }
+
+    if ((size_t)length < sizeof(buffer)) {
+        return write((const uint8_t*)buffer, length);
+    }
+
+    char* pBuffer = (char*)malloc(length + 1);
+
+    va_start(args, format);
+    vsnprintf(pBuffer, length + 1, format, args);
+    va_end(args);
+
+    size_t count = write((const uint8_t*)pBuffer, length);
+    free(pBuffer);
+
+    return count;
+}
+
+// only what is already there: the game never waits for more
+size_t Stream::readBytes(uint8_t* pBuffer, size_t length) {
+    size_t count = 0;
+
+    while (count < length) {
+        int c = read();
+
+        if (c < 0) {
+            break;
+        }
+
+        pBuffer[count++] = (uint8_t)c;
+    }
+
+    return count;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* pBuffer, size_t size) {
+    return fwrite(pBuffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+// random numbers
+
+static std::mutex s_RandomMutex;
+static std::mt19937 s_Random(std::random_device{}());
+static std::random_device s_Hardware;
+
+long random(long max) {
+    return random(0, max);
+}
+
+long random(long min, long max) {
+    if (min >= max) {
+        return min;
+    }
+
+    std::lock_guard<std::mutex> lock(s_RandomMutex);
+
+    return min + (long)(s_Random() % (uint32_t)(max - min));
+}
+
+void randomSeed(unsigned long seed) {
+    std::lock_guard<std::mutex> lock(s_RandomMutex);
+
+    s_Random.seed(seed);
+}
+
+uint32_t esp_random() {
+    std::lock_guard<std::mutex> lock(s_RandomMutex);
+
+    return s_Hardware();
+}
+
+// buzzer
+
+static std::mutex s_TonesMutex;
+static std::vector<Native::Tone> s_Tones;
+
+void ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolution) {
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+}
+
+uint32_t ledcWriteTone(uint8_t channel, uint32_t frequency) {
+    std::lock_guard<std::mutex> lock(s_TonesMutex);
+
+    Native::Tone tone = { Native::now(), frequency };
+    s_Tones.push_back(tone);
+
+    return frequency;
+}
+
+const std::vector<Native::Tone>& Native::tones() {
+    return s_Tones;
+}
+
+void Native::clearTones() {
+    std::lock_guard<std::mutex> lock(s_TonesMutex);
+
+    s_Tones.clear();
+}
+
+// I2C
+
+static std::mutex s_TransmissionsMutex;
+static std::vector<Native::Transmission> s_Transmissions;
+
+void TwoWire::beginTransmission(uint8_t address) {
+    m_Address = address;
+    m_Length = 0;
+    m_bTransmitting = true;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    if (!m_bTransmitting) {
+        return 4; // other error
+    }
+
+    std::lock_guard<std::mutex> lock(s_TransmissionsMutex);
+
+    Native::Transmission transmission = { m_Address, std::vector<uint8_t>(m_Buffer, m_Buffer + m_Length) };
+    s_Transmissions.push_back(transmission);
+    m_bTransmitting = false;
+
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t c) {
+    if (!m_bTransmitting || m_Length >= sizeof(m_Buffer)) {
+        return 0;
+    }
+
+    m_Buffer[m_Length++] = c;
+
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* pBuffer, size_t size) {
+    size_t count = 0;
+
+    while (count < size && write(pBuffer[count])) {
+        count++;
+    }
+
+    return count;
+}
+
+const std::vector<Native::Transmission>& Native::transmissions() {
+    return s_Transmissions;
+}
+
+void Native::clearTransmissions() {
+    std::lock_guard<std::mutex> lock(s_TransmissionsMutex);
+
+    s_Transmissions.clear();
+}
@@ -0,0 +1,224 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h)
+: WIDTH(w), HEIGHT(h), _width(w), _height(h), cursor_x(0), cursor_y(0), textcolor(0xFFFF),
+  textsize_x(1), textsize_y(1), rotation(0) {
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (w < 0) {
+        x += w + 1;
+        w = -w;
+    }
+
+    if (h < 0) {
+        y += h + 1;
+        h = -h;
+    }
+
+    for (int16_t i = x; i < x + w; i++) {
+        for (int16_t j = y; j < y + h; j++) {
+            drawPixel(i, j, color);
+        }
+    }
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+    fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::setRotation(uint8_t r) {
+    rotation = r & 3;
+    _width = (rotation & 1) ? HEIGHT : WIDTH;
+    _height = (rotation & 1) ? WIDTH : HEIGHT;
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        cursor_x = 0;
+        cursor_y += textsize_y * 8;
+    } else if (c != '\r') {
+        cursor_x += textsize_x * 6;
+    }
+
+    return 1;
+}
+
+bool Adafruit_GFX::transform(int16_t* pX, int16_t* pY) const {
+    int16_t x = *pX;
+    int16_t y = *pY;
+
+    if (x < 0 || y < 0 || x >= _width || y >= _height) {
+        return false;
+    }
+
+    switch (rotation) {
+    case 1:
+        *pX = WIDTH - 1 - y;
+        *pY = x;
+        break;
+    case 2:
+        *pX = WIDTH - 1 - x;
+        *pY = HEIGHT - 1 - y;
+        break;
+    case 3:
+        *pX = y;
+        *pY = HEIGHT - 1 - x;
+        break;
+    }
+
+    return true;
+}
+
+GFXcanvas1::GFXcanvas1(uint16_t w, uint16_t h)
+: Adafruit_GFX(w, h) {
+    buffer = (uint8_t*)calloc(((w + 7) / 8) * h, 1);
+}
+
+GFXcanvas1::~GFXcanvas1() {
+    free(buffer);
+}
+
+void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (buffer == NULL || !transform(&x, &y)) {
+        return;
+    }
+
+    uint8_t* pByte = &buffer[(x / 8) + y * ((WIDTH + 7) / 8)];
+
+    if (color) {
+        *pByte |= 0x80 >> (x & 7);
+    } else {
+        *pByte &= ~(0x80 >> (x & 7));
+    }
+}
+
+void GFXcanvas1::fillScreen(uint16_t color) {
+    if (buffer != NULL) {
+        memset(buffer, color ? 0xFF : 0x00, ((WIDTH + 7) / 8) * HEIGHT);
+    }
+}
+
+bool GFXcanvas1::getPixel(int16_t x, int16_t y) const {
+    if (buffer == NULL || !transform(&x, &y)) {
+        return false;
+    }
+
+    return (buffer[(x / 8) + y * ((WIDTH + 7) / 8)] & (0x80 >> (x & 7))) != 0;
+}
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst_pin)
+: Adafruit_GFX(w, h), wire(twi), buffer(NULL), i2caddr(0), vccstate(0), contrast(0) {
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+    free(buffer);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t addr, bool reset, bool periphBegin) {
+    if (buffer == NULL && (buffer = (uint8_t*)malloc(WIDTH * ((HEIGHT + 7) / 8))) == NULL) {
+        return false;
+    }
+
+    clearDisplay();
+
+    i2caddr = addr ? addr : 0x3C;
+    vccstate = switchvcc;
+    contrast = 0xCF;
+
+    return true;
+}
+
+void Adafruit_SSD1306::display() {
+    static const uint8_t WINDOW[] = { 0x00, 0x22, 0x00, 0xFF, 0x21, 0x00 };
+    const size_t CHUNK = 127; // data bytes after the control byte, for a 128 byte transmit buffer
+    size_t count = WIDTH * ((HEIGHT + 7) / 8);
+
+    wire->beginTransmission(i2caddr);
+    wire->write(WINDOW, sizeof(WINDOW));
+    wire->write((uint8_t)(WIDTH - 1));
+    wire->endTransmission();
+
+    for (size_t i = 0; i < count; i += CHUNK) {
+        wire->beginTransmission(i2caddr);
+        wire->write((uint8_t)0x40);
+        wire->write(buffer + i, (count - i < CHUNK) ? count - i : CHUNK);
+        wire->endTransmission();
+    }
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+    if (buffer != NULL) {
+        memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+    }
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (buffer == NULL || !transform(&x, &y)) {
+        return;
+    }
+
+    uint8_t* pByte = &buffer[x + (y / 8) * WIDTH];
+    uint8_t bit = 1 << (y & 7);
+
+    switch (color) {
+    case SSD1306_WHITE:
+        *pByte |= bit;
+        break;
+    case SSD1306_BLACK:
+        *pByte &= ~bit;
+        break;
+    case SSD1306_INVERSE:
+        *pByte ^= bit;
+        break;
+    }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) {
+    if (buffer == NULL || !transform(&x, &y)) {
+        return false;
+    }
+
+    return (buffer[x + (y / 8) * WIDTH] & (1 << (y & 7))) != 0;
+}
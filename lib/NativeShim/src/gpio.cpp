@@ -0,0 +1,238 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <atomic>
+
+#include <driver/gpio.h>
+#include <esp_now.h>
+#include <esp_sleep.h>
+
+#include "Native.h"
+#include "kernel.h"
+
+#define PIN_COUNT 49
+
+typedef struct {
+    int level;
+    void (*handler)(void*);
+    void* arg;
+    gpio_int_type_t type;
+    bool enabled;
+    bool wakeup;
+} Pin;
+
+// pins are guarded by their own lock: the handlers take the kernel one
+static std::mutex s_PinsMutex;
+static Pin s_Pins[PIN_COUNT];
+static std::atomic<uint32_t> s_LightSleeps(0);
+
+static bool levelActive(const Pin& pin) {
+    return (pin.type == GPIO_INTR_HIGH_LEVEL && pin.level == HIGH) || (pin.type == GPIO_INTR_LOW_LEVEL && pin.level == LOW);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    assert(pin < PIN_COUNT);
+}
+
+int digitalRead(uint8_t pin) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    return s_Pins[pin].level;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    s_Pins[pin].handler = handler;
+    s_Pins[pin].arg = arg;
+    s_Pins[pin].type = (mode == RISING) ? GPIO_INTR_POSEDGE : (mode == FALLING) ? GPIO_INTR_NEGEDGE : GPIO_INTR_ANYEDGE;
+    s_Pins[pin].enabled = true;
+}
+
+void detachInterrupt(uint8_t pin) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    s_Pins[pin].handler = NULL;
+    s_Pins[pin].type = GPIO_INTR_DISABLE;
+    s_Pins[pin].enabled = false;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    s_Pins[pin].type = type;
+
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t pin) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    s_Pins[pin].enabled = true;
+
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t pin) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    s_Pins[pin].enabled = false;
+
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) {
+    assert(pin < PIN_COUNT && (type == GPIO_INTR_HIGH_LEVEL || type == GPIO_INTR_LOW_LEVEL));
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    s_Pins[pin].type = type;
+    s_Pins[pin].wakeup = true;
+
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t pin) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    s_Pins[pin].wakeup = false;
+
+    return ESP_OK;
+}
+
+void Native::setPin(uint8_t pin, int level) {
+    assert(pin < PIN_COUNT);
+    std::unique_lock<std::mutex> pinsLock(s_PinsMutex);
+
+    Pin& state = s_Pins[pin];
+    int previous = state.level;
+    state.level = level;
+
+    bool fire = state.enabled && state.handler != NULL && (
+        (state.type == GPIO_INTR_ANYEDGE && level != previous) ||
+        (state.type == GPIO_INTR_POSEDGE && previous == LOW && level == HIGH) ||
+        (state.type == GPIO_INTR_NEGEDGE && previous == HIGH && level == LOW) ||
+        levelActive(state));
+    void (*handler)(void*) = state.handler;
+    void* arg = state.arg;
+
+    pinsLock.unlock();
+
+    if (fire) {
+        handler(arg);
+    }
+
+    // a light sleep may be over
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+    Kernel::changed();
+}
+
+bool Native::interruptEnabled(uint8_t pin) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    return s_Pins[pin].enabled;
+}
+
+int Native::interruptType(uint8_t pin) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    return s_Pins[pin].type;
+}
+
+bool Native::wakeupEnabled(uint8_t pin) {
+    assert(pin < PIN_COUNT);
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    return s_Pins[pin].wakeup;
+}
+
+bool Native::interruptStorm() {
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    for (int i = 0; i < PIN_COUNT; i++) {
+        if (s_Pins[i].enabled && s_Pins[i].handler != NULL && levelActive(s_Pins[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint32_t Native::lightSleeps() {
+    return s_LightSleeps;
+}
+
+// sleep
+
+static bool wakeupActive() {
+    std::lock_guard<std::mutex> lock(s_PinsMutex);
+
+    for (int i = 0; i < PIN_COUNT; i++) {
+        if (s_Pins[i].wakeup && levelActive(s_Pins[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+    s_LightSleeps++;
+
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+    Kernel::wait(lock, wakeupActive, Kernel::FOREVER);
+
+    return ESP_OK;
+}
+
+// radio
+
+esp_err_t esp_now_init() {
+    return ESP_FAIL;
+}
+
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t* pPeer) {
+    return ESP_FAIL;
+}
+
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t callback) {
+    return ESP_FAIL;
+}
+
+esp_err_t esp_now_send(const uint8_t* pAddress, const uint8_t* pData, size_t length) {
+    return ESP_FAIL;
+}
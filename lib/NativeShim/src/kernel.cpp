@@ -0,0 +1,581 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <pthread.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <esp_timer.h>
+
+#include "Native.h"
+#include "kernel.h"
+
+struct NativeTask {
+    std::string name;
+    uint32_t notifications;
+};
+
+struct NativeEventGroup {
+    EventBits_t bits;
+};
+
+struct NativeQueue {
+    size_t length;
+    size_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+struct NativeTimer {
+    esp_timer_cb_t callback;
+    void* arg;
+    bool armed;
+    uint64_t due; // microseconds
+    uint64_t period; // 0 for a one-shot timer
+};
+
+typedef struct {
+    const std::function<bool()>* pReady;
+    uint64_t deadline;
+    bool task; // counted in s_Running
+    bool woken;
+    std::condition_variable* pWakeup;
+} Wait;
+
+// the state shared with the tasks is never destroyed: detached threads still wait on it when the test exits,
+// and destroying a condition variable they wait on blocks the exit forever
+static std::mutex s_Mutex;
+static std::list<Wait*>& s_Waits = *new std::list<Wait*>;
+static int s_Running = 0; // tasks not waiting for anything
+static std::condition_variable& s_Quiet = *new std::condition_variable; // s_Running dropped
+static thread_local NativeTask* t_pTask = NULL; // NULL for the threads not created by xTaskCreate()
+
+static const std::chrono::steady_clock::time_point s_Start = std::chrono::steady_clock::now();
+static std::atomic<bool> s_bVirtual(false);
+static std::atomic<uint64_t> s_VirtualNow(0);
+
+static std::vector<NativeTimer*>& s_Timers = *new std::vector<NativeTimer*>;
+static std::condition_variable& s_TimersChanged = *new std::condition_variable;
+
+static std::chrono::steady_clock::time_point wallClock(uint64_t micros) {
+    return s_Start + std::chrono::microseconds(micros);
+}
+
+static void release(Wait* pWait) {
+    pWait->woken = true;
+
+    if (pWait->task) {
+        s_Running++;
+    }
+
+    pWait->pWakeup->notify_one();
+}
+
+std::unique_lock<std::mutex> Kernel::lock() {
+    return std::unique_lock<std::mutex>(s_Mutex);
+}
+
+bool Kernel::wait(std::unique_lock<std::mutex>& lock, const std::function<bool()>& ready, uint64_t timeout) {
+    uint64_t deadline = (timeout == FOREVER) ? FOREVER : Native::now() + timeout;
+
+    for (;;) {
+        if (ready()) {
+            return true;
+        }
+
+        if (Native::now() >= deadline) {
+            return false;
+        }
+
+        std::condition_variable wakeup;
+        Wait wait = { &ready, deadline, t_pTask != NULL, false, &wakeup };
+
+        s_Waits.push_back(&wait);
+
+        if (wait.task) {
+            s_Running--;
+            s_Quiet.notify_all();
+        }
+
+        // woken up by changed(), by advance() in virtual time, or by the wall clock
+        while (!wait.woken) {
+            if (s_bVirtual || deadline == FOREVER) {
+                wakeup.wait(lock);
+            } else if (wakeup.wait_until(lock, wallClock(deadline)) == std::cv_status::timeout && !wait.woken) {
+                s_Waits.remove(&wait);
+                release(&wait);
+            }
+        }
+    }
+}
+
+void Kernel::changed() {
+    uint64_t now = Native::now();
+
+    for (std::list<Wait*>::iterator i = s_Waits.begin(); i != s_Waits.end();) {
+        Wait* pWait = *i;
+
+        if ((*pWait->pReady)() || (s_bVirtual && now >= pWait->deadline)) {
+            i = s_Waits.erase(i);
+            release(pWait);
+        } else {
+            ++i;
+        }
+    }
+}
+
+uint64_t Kernel::timeout(TickType_t ticks) {
+    return (ticks == portMAX_DELAY) ? FOREVER : (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+// time
+
+void Native::useVirtualTime() {
+    std::unique_lock<std::mutex> lock(s_Mutex);
+
+    s_VirtualNow = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_Start).count();
+    s_bVirtual = true;
+}
+
+bool Native::virtualTime() {
+    return s_bVirtual;
+}
+
+uint64_t Native::now() {
+    if (s_bVirtual) {
+        return s_VirtualNow;
+    }
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_Start).count();
+}
+
+// runs the earliest timer due, if any, with the lock released
+static bool runTimer(std::unique_lock<std::mutex>& lock) {
+    NativeTimer* pDue = NULL;
+    uint64_t now = Native::now();
+
+    for (size_t i = 0; i < s_Timers.size(); i++) {
+        if (s_Timers[i]->armed && s_Timers[i]->due <= now && (pDue == NULL || s_Timers[i]->due < pDue->due)) {
+            pDue = s_Timers[i];
+        }
+    }
+
+    if (pDue == NULL) {
+        return false;
+    }
+
+    if (pDue->period > 0) {
+        pDue->due += pDue->period;
+    } else {
+        pDue->armed = false;
+    }
+
+    esp_timer_cb_t callback = pDue->callback;
+    void* arg = pDue->arg;
+
+    lock.unlock();
+    callback(arg);
+    lock.lock();
+
+    return true;
+}
+
+void Native::advance(uint64_t microseconds) {
+    std::unique_lock<std::mutex> lock(s_Mutex);
+
+    assert(s_bVirtual);
+
+    uint64_t target = s_VirtualNow + microseconds;
+
+    for (;;) {
+        s_Quiet.wait(lock, [] { return s_Running == 0; });
+
+        if (runTimer(lock)) {
+            continue;
+        }
+
+        uint64_t now = s_VirtualNow;
+        uint64_t next = target;
+        bool expired = false;
+
+        for (std::list<Wait*>::iterator i = s_Waits.begin(); i != s_Waits.end(); ++i) {
+            expired = expired || (*i)->deadline <= now;
+            next = ((*i)->deadline < next) ? (*i)->deadline : next;
+        }
+
+        for (size_t i = 0; i < s_Timers.size(); i++) {
+            if (s_Timers[i]->armed && s_Timers[i]->due < next) {
+                next = s_Timers[i]->due;
+            }
+        }
+
+        if (!expired) {
+            if (now >= target) {
+                break;
+            }
+
+            s_VirtualNow = next;
+        }
+
+        Kernel::changed();
+    }
+}
+
+uint32_t millis() {
+    return (uint32_t)(Native::now() / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t)Native::now();
+}
+
+void delay(uint32_t ms) {
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    Kernel::wait(lock, [] { return false; }, (uint64_t)ms * 1000);
+}
+
+uint32_t EspClass::getCycleCount() {
+    // always the wall clock: the benchmarks measure the machine, not the simulation
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Start).count();
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return 1000; // one cycle per nanosecond
+}
+
+// tasks
+
+static void runTask(TaskFunction_t function, void* pParameters, NativeTask* pTask) {
+    t_pTask = pTask;
+    function(pParameters);
+    vTaskDelete(NULL); // a task function must not return, as on the chip
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack, void* pParameters, UBaseType_t priority, TaskHandle_t* pTask) {
+    NativeTask* pNew = new NativeTask;
+    pNew->name = name;
+    pNew->notifications = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(s_Mutex);
+        s_Running++;
+    }
+
+    std::thread(runTask, function, pParameters, pNew).detach();
+
+    if (pTask != NULL) {
+        *pTask = pNew;
+    }
+
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack, void* pParameters, UBaseType_t priority, TaskHandle_t* pTask, BaseType_t core) {
+    return xTaskCreate(function, name, stack, pParameters, priority, pTask);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    assert(task == NULL && t_pTask != NULL);
+
+    {
+        std::unique_lock<std::mutex> lock(s_Mutex);
+        s_Running--;
+        s_Quiet.notify_all();
+    }
+
+    pthread_exit(NULL);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (t_pTask == NULL) {
+        // the main thread, or any other one: it gets a handle for its notifications, but it is not a task
+        static std::mutex s_Others;
+        std::unique_lock<std::mutex> lock(s_Others);
+        static thread_local NativeTask* t_pOther = NULL;
+
+        if (t_pOther == NULL) {
+            t_pOther = new NativeTask;
+            t_pOther->notifications = 0;
+        }
+
+        return t_pOther;
+    }
+
+    return t_pTask;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    Kernel::wait(lock, [] { return false; }, Kernel::timeout(ticks));
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    task->notifications++;
+    Kernel::changed();
+
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* pHigherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+
+    if (pHigherPriorityTaskWoken != NULL) {
+        *pHigherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    NativeTask* pTask = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    Kernel::wait(lock, [pTask] { return pTask->notifications > 0; }, Kernel::timeout(ticksToWait));
+
+    uint32_t value = pTask->notifications;
+
+    if (value > 0) {
+        pTask->notifications = clearCountOnExit ? 0 : value - 1;
+    }
+
+    return value;
+}
+
+// event groups
+
+EventGroupHandle_t xEventGroupCreate() {
+    NativeEventGroup* pGroup = new NativeEventGroup;
+    pGroup->bits = 0;
+
+    return pGroup;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) {
+    delete group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    group->bits |= bits;
+    EventBits_t value = group->bits;
+    Kernel::changed(); // may clear them again
+
+    return value;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    EventBits_t value = group->bits;
+    group->bits &= ~bits;
+
+    return value;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit, BaseType_t waitForAllBits, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    bool set = Kernel::wait(lock, [group, bits, waitForAllBits] {
+        return waitForAllBits ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+    }, Kernel::timeout(ticksToWait));
+
+    EventBits_t value = group->bits;
+
+    if (set && clearOnExit) {
+        group->bits &= ~bits;
+    }
+
+    return value;
+}
+
+// queues
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    NativeQueue* pQueue = new NativeQueue;
+    pQueue->length = length;
+    pQueue->itemSize = itemSize;
+
+    return pQueue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* pItem, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    if (!Kernel::wait(lock, [queue] { return queue->items.size() < queue->length; }, Kernel::timeout(ticksToWait))) {
+        return pdFAIL;
+    }
+
+    const uint8_t* pBytes = static_cast<const uint8_t*>(pItem);
+    queue->items.push_back(std::vector<uint8_t>(pBytes, pBytes + queue->itemSize));
+    Kernel::changed();
+
+    return pdPASS;
+}
+
+static BaseType_t takeItem(QueueHandle_t queue, void* pItem, TickType_t ticksToWait, bool remove) {
+    std::unique_lock<std::mutex> lock = Kernel::lock();
+
+    if (!Kernel::wait(lock, [queue] { return !queue->items.empty(); }, Kernel::timeout(ticksToWait))) {
+        return pdFAIL;
+    }
+
+    memcpy(pItem, queue->items.front().data(), queue->itemSize);
+
+    if (remove) {
+        queue->items.pop_front();
+        Kernel::changed();
+    }
+
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* pItem, TickType_t ticksToWait) {
+    return takeItem(queue, pItem, ticksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* pItem, TickType_t ticksToWait) {
+    return takeItem(queue, pItem, ticksToWait, false);
+}
+
+// esp_timer: callbacks run in a thread of their own on the wall clock, in advance() in virtual time
+
+static void dispatchTimers() {
+    std::unique_lock<std::mutex> lock(s_Mutex);
+
+    for (;;) {
+        if (s_bVirtual) {
+            s_TimersChanged.wait(lock);
+            continue;
+        }
+
+        if (runTimer(lock)) {
+            continue;
+        }
+
+        NativeTimer* pNext = NULL;
+
+        for (size_t i = 0; i < s_Timers.size(); i++) {
+            if (s_Timers[i]->armed && (pNext == NULL || s_Timers[i]->due < pNext->due)) {
+                pNext = s_Timers[i];
+            }
+        }
+
+        if (pNext == NULL) {
+            s_TimersChanged.wait(lock);
+        } else {
+            s_TimersChanged.wait_until(lock, wallClock(pNext->due));
+        }
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* pArgs, esp_timer_handle_t* pTimer) {
+    static std::once_flag s_Dispatcher;
+    std::call_once(s_Dispatcher, [] { std::thread(dispatchTimers).detach(); });
+
+    NativeTimer* pNew = new NativeTimer;
+    pNew->callback = pArgs->callback;
+    pNew->arg = pArgs->arg;
+    pNew->armed = false;
+    pNew->due = 0;
+    pNew->period = 0;
+
+    std::unique_lock<std::mutex> lock(s_Mutex);
+    s_Timers.push_back(pNew);
+    *pTimer = pNew;
+
+    return ESP_OK;
+}
+
+static esp_err_t startTimer(esp_timer_handle_t timer, uint64_t timeout, uint64_t period) {
+    std::unique_lock<std::mutex> lock(s_Mutex);
+
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    timer->armed = true;
+    timer->due = Native::now() + timeout;
+    timer->period = period;
+    s_TimersChanged.notify_all();
+
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout) {
+    return startTimer(timer, timeout, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    return startTimer(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    std::unique_lock<std::mutex> lock(s_Mutex);
+
+    if (!timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    timer->armed = false;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    std::unique_lock<std::mutex> lock(s_Mutex);
+
+    for (size_t i = 0; i < s_Timers.size(); i++) {
+        if (s_Timers[i] == timer) {
+            s_Timers.erase(s_Timers.begin() + i);
+            break;
+        }
+    }
+
+    delete timer;
+
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time() {
+    return Native::now();
+}
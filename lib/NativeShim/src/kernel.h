@@ -0,0 +1,48 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+// the emulated FreeRTOS kernel, shared by the sources of the shim
+#include <Arduino.h>
+#include <functional>
+#include <mutex>
+
+namespace Kernel {
+
+const uint64_t FOREVER = UINT64_MAX;
+
+// every kernel object is guarded by a single lock, as if there was a single core
+std::unique_lock<std::mutex> lock();
+
+// blocks the calling thread until ready() holds or the timeout (microseconds) expires, the lock must be held
+// ready() is called with the lock held, by whichever thread may have made it true
+bool wait(std::unique_lock<std::mutex>& lock, const std::function<bool()>& ready, uint64_t timeout);
+
+// something changed: the waits that are ready go on, the lock must be held
+void changed();
+
+uint64_t timeout(TickType_t ticks); // microseconds
+
+}
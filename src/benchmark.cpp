@@ -0,0 +1,412 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "benchmark.h"
+
+#define BENCHMARK_SEED 0x2545F491
+
+// keeps the compiler from optimizing the measured calls away
+static volatile uint32_t s_Sink;
+
+// the "ns" of the named result in a previous report, 0 if there is none
+static uint32_t baselineOf(const char* pBaseline, const char* name) {
+    char key[64];
+    snprintf(key, sizeof(key), "\"name\":\"%s\"", name);
+
+    const char* pResult = strstr(pBaseline, key);
+    const char* pValue = pResult ? strstr(pResult, "\"ns\":") : NULL;
+
+    return pValue ? strtoul(pValue + 5, NULL, 10) : 0;
+}
+
+Benchmark::Benchmark()
+: m_Game(&m_Joystick, &m_Renderer), m_Random(BENCHMARK_SEED) {
+}
+
+Benchmark::~Benchmark() {
+}
+
+bool Benchmark::run(Print* pReport, const char* pBaseline) {
+    static const struct {
+        const char* name;
+        uint32_t (Benchmark::*measure)();
+    } BENCHMARKS[] = {
+        {"tetrominoOverlaps", &Benchmark::benchOverlaps},
+        {"moveTetromino", &Benchmark::benchMove},
+        {"rotateTetromino", &Benchmark::benchRotate},
+        {"placeTetromino", &Benchmark::benchPlace},
+        {"clearCompletedRows", &Benchmark::benchClearRows},
+        {"compactBoard", &Benchmark::benchCompact},
+        {"render", &Benchmark::benchRender},
+        {"RandomStream::next", &Benchmark::benchRandom},
+        {"PieceGenerator::next", &Benchmark::benchPieces}
+    };
+
+    if (!m_Renderer.begin()) {
+        pReport->println(F("Benchmark renderer initialization failed!"));
+        return false;
+    }
+
+    generateCorpus();
+
+    // the rules of the build, so runs of different rule policies are not compared by mistake
+    char context[128];
+    snprintf(context, sizeof(context), "\"cpu_mhz\":%u,\"boards\":%d,\"rules\":{\"kicks\":%u,\"hold\":%s,\"lock_delay\":%u}",
+        getCpuFrequencyMhz(), BENCHMARK_BOARDS, Rules::Rotation::KICKS, Rules::Hold::ENABLED ? "true" : "false", Rules::Lock::DELAY);
+
+    if (pBaseline != NULL && strstr(pBaseline, context) == NULL) {
+        pBaseline = NULL;
+    }
+
+    bool regressed = false;
+
+    pReport->printf("{%s,\"benchmarks\":[", context);
+
+    for (size_t i = 0; i < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); i++) {
+        uint32_t nanoseconds = UINT32_MAX;
+        uint32_t baseline = pBaseline ? baselineOf(pBaseline, BENCHMARKS[i].name) : 0;
+        const char* status = "new";
+
+        for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+            uint32_t measured = (this->*BENCHMARKS[i].measure)();
+            nanoseconds = (measured < nanoseconds) ? measured : nanoseconds;
+        }
+
+        if (baseline > 0) {
+            // one nanosecond is the resolution of the report
+            if ((uint64_t)nanoseconds * 100 > (uint64_t)baseline * (100 + BENCHMARK_THRESHOLD) && nanoseconds > baseline + 1) {
+                status = "regressed";
+                regressed = true;
+            } else {
+                status = "ok";
+            }
+        }
+
+        pReport->printf("%s{\"name\":\"%s\",\"ns\":%u,\"baseline\":%u,\"status\":\"%s\"}",
+            (i > 0) ? "," : "", BENCHMARKS[i].name, nanoseconds, baseline, status);
+    }
+
+    pReport->printf("],\"result\":\"%s\"}\n", regressed ? "fail" : "pass");
+
+    return !regressed;
+}
+
+// boards left by random play: pieces dropped in random columns, completed rows removed
+void Benchmark::generateCorpus() {
+    m_Random = BENCHMARK_SEED;
+
+    for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+        m_Game.clear();
+
+        for (int k = 0; k < b * 10; k++) {
+            TetrominoType type = static_cast<TetrominoType>(next() % TETROMINO_COUNT);
+            TetrominoRotation rotation = static_cast<TetrominoRotation>(next() % ROTATION_COUNT);
+            bool spawned = false;
+
+            for (int attempt = 0; attempt < 10 && !spawned; attempt++) {
+                spawn(type, rotation, next() % BOARD_WIDTH, BOARD_HEIGHT - 1);
+                spawned = !m_Game.tetrominoOverlaps();
+            }
+
+            if (!spawned) {
+                break; // the stack reached the top
+            }
+
+            while (m_Game.moveTetromino(0, -1)) {
+            }
+
+            m_Game.placeTetromino();
+
+            if (m_Game.clearCompletedRows()) {
+                m_Game.compactBoard();
+            }
+        }
+
+        memcpy(m_Corpus[b], m_Game.m_Board, sizeof(m_Game.m_Board));
+    }
+}
+
+void Benchmark::load(int board) {
+    memcpy(m_Game.m_Board, m_Corpus[board], sizeof(m_Game.m_Board));
+
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        m_Game.m_Completed[i] = false;
+    }
+}
+
+void Benchmark::completeRows(Board board, int index) {
+    int rows[2] = { 0, 1 + index % 4 };
+
+    for (int r = 0; r < 2; r++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            board[rows[r]][j] = true;
+        }
+    }
+}
+
+void Benchmark::spawn(TetrominoType type, TetrominoRotation rotation, int8_t x, int8_t y) {
+    m_Game.m_TetrominoType = type;
+    m_Game.m_TetrominoRotation = rotation;
+    m_Game.m_TetrominoX = x;
+    m_Game.m_TetrominoY = y;
+    m_Game.m_pTetromino = &(Pieces[type][rotation]);
+}
+
+// xorshift32, so the corpus is the same on every run
+uint32_t Benchmark::next() {
+    m_Random ^= m_Random << 13;
+    m_Random ^= m_Random >> 17;
+    m_Random ^= m_Random << 5;
+
+    return m_Random;
+}
+
+// every measurement accumulates CPU cycles around the measured calls only,
+// then converts them to nanoseconds per call
+#define NANOSECONDS(cycles, ops) ((uint32_t)((cycles) * 1000 / getCpuFrequencyMhz() / ((ops) ? (ops) : 1)))
+
+uint32_t Benchmark::benchOverlaps() {
+    uint64_t cycles = 0;
+    uint32_t ops = 0;
+
+    for (int repeat = 0; repeat < BENCHMARK_REPEAT; repeat++) {
+        for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+            load(b);
+
+            for (int t = 0; t < TETROMINO_COUNT; t++) {
+                for (int r = 0; r < ROTATION_COUNT; r++) {
+                    const Tetromino* pTetromino = &(Pieces[t][r]);
+                    spawn(static_cast<TetrominoType>(t), static_cast<TetrominoRotation>(r), BOARD_WIDTH / 2 - 1, BOARD_HEIGHT - 1);
+
+                    uint32_t startTime = ESP.getCycleCount();
+
+                    for (int8_t deltaY = 0; deltaY > -BOARD_HEIGHT; deltaY--) {
+                        for (int8_t deltaX = -4; deltaX <= 4; deltaX++) {
+                            s_Sink += m_Game.tetrominoOverlaps(pTetromino, deltaX, deltaY);
+                        }
+                    }
+
+                    cycles += ESP.getCycleCount() - startTime;
+                    ops += BOARD_HEIGHT * 9;
+                }
+            }
+        }
+    }
+
+    return NANOSECONDS(cycles, ops);
+}
+
+uint32_t Benchmark::benchMove() {
+    uint64_t cycles = 0;
+    uint32_t ops = 0;
+
+    for (int repeat = 0; repeat < BENCHMARK_REPEAT; repeat++) {
+        for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+            load(b);
+
+            for (int t = 0; t < TETROMINO_COUNT; t++) {
+                spawn(static_cast<TetrominoType>(t), ROTATION_0, BOARD_WIDTH / 2 - 1, BOARD_HEIGHT - 1);
+
+                if (m_Game.tetrominoOverlaps()) {
+                    continue; // topped out board
+                }
+
+                uint32_t startTime = ESP.getCycleCount();
+
+                // sweep left, right, then fall down to the stack
+                while (m_Game.moveTetromino(-1)) {
+                    ops++;
+                }
+
+                while (m_Game.moveTetromino(1)) {
+                    ops++;
+                }
+
+                while (m_Game.moveTetromino(0, -1)) {
+                    ops++;
+                }
+
+                cycles += ESP.getCycleCount() - startTime;
+                ops += 3; // the failed moves
+            }
+        }
+    }
+
+    return NANOSECONDS(cycles, ops);
+}
+
+uint32_t Benchmark::benchRotate() {
+    uint64_t cycles = 0;
+    uint32_t ops = 0;
+
+    for (int repeat = 0; repeat < BENCHMARK_REPEAT; repeat++) {
+        for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+            load(b);
+
+            for (int t = 0; t < TETROMINO_COUNT; t++) {
+                spawn(static_cast<TetrominoType>(t), ROTATION_0, BOARD_WIDTH / 2 - 1, BOARD_HEIGHT - 2);
+
+                uint32_t startTime = ESP.getCycleCount();
+
+                for (int r = 0; r < ROTATION_COUNT; r++) {
+                    s_Sink += m_Game.rotateTetromino();
+                }
+
+                cycles += ESP.getCycleCount() - startTime;
+                ops += ROTATION_COUNT;
+            }
+        }
+    }
+
+    return NANOSECONDS(cycles, ops);
+}
+
+uint32_t Benchmark::benchPlace() {
+    uint64_t cycles = 0;
+    uint32_t ops = 0;
+
+    for (int repeat = 0; repeat < BENCHMARK_REPEAT; repeat++) {
+        for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+            for (int t = 0; t < TETROMINO_COUNT; t++) {
+                load(b);
+                spawn(static_cast<TetrominoType>(t), ROTATION_0, BOARD_WIDTH / 2 - 1, BOARD_HEIGHT - 1);
+
+                if (m_Game.tetrominoOverlaps()) {
+                    continue; // topped out board
+                }
+
+                while (m_Game.moveTetromino(0, -1)) {
+                }
+
+                uint32_t startTime = ESP.getCycleCount();
+
+                m_Game.placeTetromino();
+
+                cycles += ESP.getCycleCount() - startTime;
+                ops++;
+            }
+        }
+    }
+
+    return NANOSECONDS(cycles, ops);
+}
+
+uint32_t Benchmark::benchClearRows() {
+    uint64_t cycles = 0;
+    uint32_t ops = 0;
+
+    for (int repeat = 0; repeat < BENCHMARK_REPEAT; repeat++) {
+        for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+            load(b);
+            completeRows(m_Game.m_Board, b);
+
+            uint32_t startTime = ESP.getCycleCount();
+
+            s_Sink += m_Game.clearCompletedRows();
+
+            cycles += ESP.getCycleCount() - startTime;
+            ops++;
+
+            load(b); // and once more without completed rows
+
+            startTime = ESP.getCycleCount();
+
+            s_Sink += m_Game.clearCompletedRows();
+
+            cycles += ESP.getCycleCount() - startTime;
+            ops++;
+        }
+    }
+
+    return NANOSECONDS(cycles, ops);
+}
+
+uint32_t Benchmark::benchCompact() {
+    uint64_t cycles = 0;
+    uint32_t ops = 0;
+
+    for (int repeat = 0; repeat < BENCHMARK_REPEAT; repeat++) {
+        for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+            load(b);
+            completeRows(m_Game.m_Board, b);
+            m_Game.clearCompletedRows();
+
+            uint32_t startTime = ESP.getCycleCount();
+
+            m_Game.compactBoard();
+
+            cycles += ESP.getCycleCount() - startTime;
+            ops++;
+        }
+    }
+
+    return NANOSECONDS(cycles, ops);
+}
+
+uint32_t Benchmark::benchRender() {
+    uint64_t cycles = 0;
+    uint32_t ops = 0;
+
+    for (int repeat = 0; repeat < BENCHMARK_REPEAT; repeat++) {
+        for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+            load(b);
+            spawn(static_cast<TetrominoType>(b % TETROMINO_COUNT), ROTATION_0, BOARD_WIDTH / 2 - 1, BOARD_HEIGHT - 1);
+
+            uint32_t startTime = ESP.getCycleCount();
+
+            m_Game.render(Game::RENDER_MODE_PLAYING);
+
+            cycles += ESP.getCycleCount() - startTime;
+            ops++;
+        }
+    }
+
+    return NANOSECONDS(cycles, ops);
+}
+
+uint32_t Benchmark::benchRandom() {
+    RandomStream random(42);
+
+    uint32_t startTime = ESP.getCycleCount();
+
+    for (int i = 0; i < BENCHMARK_RANDOM_COUNT; i++) {
+        s_Sink += random.next();
+    }
+
+    return NANOSECONDS((uint64_t)(ESP.getCycleCount() - startTime), BENCHMARK_RANDOM_COUNT);
+}
+
+uint32_t Benchmark::benchPieces() {
+    PieceGenerator pieces(PieceGenerator::MODE_BAG);
+    pieces.seed(42);
+
+    uint32_t startTime = ESP.getCycleCount();
+
+    for (int i = 0; i < BENCHMARK_RANDOM_COUNT; i++) {
+        s_Sink += pieces.next();
+    }
+
+    return NANOSECONDS((uint64_t)(ESP.getCycleCount() - startTime), BENCHMARK_RANDOM_COUNT);
+}
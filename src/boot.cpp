@@ -0,0 +1,170 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "boot.h"
+#include "game.h"
+#include "joystick.h"
+#include "renderer.h"
+
+static const char* const STAGE_NAMES[BOOT_STAGE_COUNT] = {
+    "setup",
+    "i2c",
+    "display",
+    "first frame",
+    "serial",
+    "tasks",
+    "ready"
+};
+
+// same commands and values as Adafruit_SSD1306::begin(SSD1306_SWITCHCAPVCC) for a 128x64 panel
+static const uint8_t INIT_STREAM[] = {
+    0x00,       // control byte: a stream of commands follows
+    0xAE,       // display off
+    0xD5, 0x80, // clock divide ratio
+    0xA8, 0x3F, // multiplex: 64 rows
+    0xD3, 0x00, // display offset
+    0x40,       // start line 0
+    0x8D, 0x14, // charge pump on
+    0x20, 0x00, // horizontal addressing mode
+    0xA1,       // segment remap
+    0xC8,       // COM scan direction: decrement
+    0xDA, 0x12, // COM pins
+    0x81, 0xCF, // contrast
+    0xD9, 0xF1, // precharge period
+    0xDB, 0x40, // VCOMH deselect level
+    0xA4,       // display follows RAM
+    0xA6,       // normal, not inverted
+    0x2E,       // scrolling off
+    0xAF        // display on
+};
+
+BootProfiler::BootProfiler()
+: m_Count(0) {
+}
+
+BootProfiler::~BootProfiler() {
+}
+
+void BootProfiler::mark(BootStage stage) {
+    assert(stage < BOOT_STAGE_COUNT);
+
+    if (m_Count == BOOT_STAGE_COUNT) {
+        return;
+    }
+
+    m_Times[stage] = micros();
+    m_Order[m_Count++] = stage;
+}
+
+void BootProfiler::report() {
+    uint32_t previous = 0;
+
+    for (int i = 0; i < m_Count; i++) {
+        uint32_t time = m_Times[m_Order[i]];
+
+        Serial.printf("Boot: %-12s at %7uus (+%uus)\n", STAGE_NAMES[m_Order[i]], time, time - previous);
+        previous = time;
+    }
+}
+
+bool BootProfiler::inOrder() const {
+    for (int i = 1; i < m_Count; i++) {
+        if (m_Order[i] <= m_Order[i - 1]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+FastSSD1306::FastSSD1306(uint8_t w, uint8_t h, TwoWire* pWire, int8_t resetPin)
+: Adafruit_SSD1306(w, h, pWire, resetPin) {
+}
+
+FastSSD1306::~FastSSD1306() {
+}
+
+bool FastSSD1306::beginFast(uint8_t address) {
+    assert(WIDTH == 128 && HEIGHT == 64); // the init stream is for this panel only
+
+    if (buffer == NULL && (buffer = (uint8_t*)malloc(WIDTH * ((HEIGHT + 7) / 8))) == NULL) {
+        return false;
+    }
+
+    clearDisplay();
+
+    // what begin() would have set up
+    i2caddr = address;
+    vccstate = SSD1306_SWITCHCAPVCC;
+    contrast = 0xCF;
+
+    wire->beginTransmission(address);
+    wire->write(INIT_STREAM, sizeof(INIT_STREAM));
+
+    return wire->endTransmission() == 0;
+}
+
+bool fastBoot(BootProfiler* pBoot, TwoWire* pWire, FastSSD1306* pDisplay, uint8_t address, Renderer* pRenderer, Joystick* pJoystick, Game* pGame) {
+    pWire->begin();
+    pBoot->mark(BOOT_STAGE_I2C);
+
+    if (!pDisplay->beginFast(address)) {
+        Serial.begin(115200);
+        Serial.println(F("SSD1306 initialization failed!"));
+        return false;
+    }
+
+    pDisplay->setRotation(3);
+    pDisplay->setTextColor(SSD1306_WHITE);
+    pBoot->mark(BOOT_STAGE_DISPLAY);
+
+    if (!pRenderer->begin()) {
+        Serial.begin(115200);
+        Serial.println(F("Renderer initialization failed!"));
+        return false;
+    }
+
+    if (!pGame->begin()) {
+        Serial.begin(115200);
+        Serial.println(F("Game initialization failed!"));
+        return false;
+    }
+
+    // the first frame goes out before the non-critical init
+    pGame->showInsertCoins();
+    pBoot->mark(BOOT_STAGE_FIRST_FRAME);
+
+    Serial.begin(115200);
+    pBoot->mark(BOOT_STAGE_SERIAL);
+
+    if (!pJoystick->begin()) {
+        Serial.println(F("Joystick initialization failed!"));
+        return false;
+    }
+
+    pBoot->mark(BOOT_STAGE_TASKS);
+
+    return true;
+}
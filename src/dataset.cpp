@@ -0,0 +1,164 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "dataset.h"
+
+#define BOARD_COLUMN 0
+#define MOVE_COLUMN (BOARD_COLUMN + DATASET_CHUNK_RECORDS * PACKED_BOARD_SIZE)
+#define TRAILER (MOVE_COLUMN + DATASET_CHUNK_RECORDS * DATASET_MOVE_SIZE)
+
+DatasetWriter::DatasetWriter(Print* pOut)
+: m_pOut(pOut), m_Count(0), m_Records(0) {
+}
+
+DatasetWriter::~DatasetWriter() {
+}
+
+bool DatasetWriter::begin(size_t size) {
+    m_Count = 0;
+    m_Records = 0;
+
+    if (size == 0) {
+        uint8_t header[DATASET_HEADER_SIZE];
+
+        memcpy(header, DATASET_MAGIC, 4);
+        header[4] = DATASET_VERSION;
+        header[5] = BOARD_WIDTH;
+        header[6] = BOARD_HEIGHT;
+        header[7] = 0;
+        header[8] = DATASET_CHUNK_RECORDS & 0xFF;
+        header[9] = DATASET_CHUNK_RECORDS >> 8;
+
+        return m_pOut->write(header, DATASET_HEADER_SIZE) == DATASET_HEADER_SIZE;
+    }
+
+    if (size < DATASET_HEADER_SIZE) {
+        return false;
+    }
+
+    // a chunk cut short (the power went off while it was written) is padded with zeros, so the next ones stay in place
+    size_t padding = (DATASET_CHUNK_SIZE - (size - DATASET_HEADER_SIZE) % DATASET_CHUNK_SIZE) % DATASET_CHUNK_SIZE;
+    memset(m_Chunk, 0, padding);
+
+    return m_pOut->write(m_Chunk, padding) == padding;
+}
+
+bool DatasetWriter::add(const uint8_t* pBoard, TetrominoType type, TetrominoRotation rotation, int8_t x, int8_t y, uint8_t lines) {
+    assert(x >= 0 && x < 16);
+    assert(y >= 0 && y < BOARD_HEIGHT);
+    assert(lines <= 4);
+
+    uint32_t move = type | (rotation << 3) | (x << 5) | (y << 9) | (lines << 14);
+    uint8_t* pMove = &m_Chunk[MOVE_COLUMN + m_Count * DATASET_MOVE_SIZE];
+
+    memcpy(&m_Chunk[BOARD_COLUMN + m_Count * PACKED_BOARD_SIZE], pBoard, PACKED_BOARD_SIZE);
+    pMove[0] = move & 0xFF;
+    pMove[1] = (move >> 8) & 0xFF;
+    pMove[2] = (move >> 16) & 0xFF;
+
+    m_Count++;
+    m_Records++;
+
+    if (m_Count == DATASET_CHUNK_RECORDS) {
+        return flush();
+    }
+
+    return true;
+}
+
+bool DatasetWriter::flush() {
+    if (m_Count > 0) {
+        // unused slots are zeroed, so the output does not depend on what was there before
+        memset(&m_Chunk[BOARD_COLUMN + m_Count * PACKED_BOARD_SIZE], 0, (DATASET_CHUNK_RECORDS - m_Count) * PACKED_BOARD_SIZE);
+        memset(&m_Chunk[MOVE_COLUMN + m_Count * DATASET_MOVE_SIZE], 0, (DATASET_CHUNK_RECORDS - m_Count) * DATASET_MOVE_SIZE);
+
+        m_Chunk[TRAILER] = m_Count & 0xFF;
+        m_Chunk[TRAILER + 1] = m_Count >> 8;
+        m_Chunk[TRAILER + 2] = DATASET_CHUNK_MARKER & 0xFF;
+        m_Chunk[TRAILER + 3] = DATASET_CHUNK_MARKER >> 8;
+
+        m_Count = 0;
+
+        if (m_pOut->write(m_Chunk, DATASET_CHUNK_SIZE) != DATASET_CHUNK_SIZE) {
+            return false;
+        }
+    }
+
+    // a File only reaches the flash when flushed or closed
+    m_pOut->flush();
+
+    return true;
+}
+
+DatasetReader::DatasetReader(const uint8_t* pData, size_t size)
+: m_pData(pData), m_Size(size) {
+}
+
+DatasetReader::~DatasetReader() {
+}
+
+bool DatasetReader::valid() const {
+    return m_Size >= DATASET_HEADER_SIZE
+        && memcmp(m_pData, DATASET_MAGIC, 4) == 0
+        && m_pData[4] == DATASET_VERSION
+        && m_pData[5] == BOARD_WIDTH
+        && m_pData[6] == BOARD_HEIGHT
+        && (m_pData[8] | (m_pData[9] << 8)) == DATASET_CHUNK_RECORDS;
+}
+
+// a chunk cut short at the end of the file is ignored
+size_t DatasetReader::chunks() const {
+    return valid() ? (m_Size - DATASET_HEADER_SIZE) / DATASET_CHUNK_SIZE : 0;
+}
+
+uint16_t DatasetReader::chunkRecords(size_t chunk) const {
+    assert(chunk < chunks());
+
+    const uint8_t* pTrailer = m_pData + DATASET_HEADER_SIZE + chunk * DATASET_CHUNK_SIZE + TRAILER;
+    uint16_t count = pTrailer[0] | (pTrailer[1] << 8);
+    uint16_t marker = pTrailer[2] | (pTrailer[3] << 8);
+
+    // no marker: the power went off before the end of the chunk was written
+    return (marker != DATASET_CHUNK_MARKER || count > DATASET_CHUNK_RECORDS) ? 0 : count;
+}
+
+bool DatasetReader::record(size_t chunk, uint16_t index, DatasetRecord* pRecord) const {
+    if (chunk >= chunks() || index >= chunkRecords(chunk)) {
+        return false;
+    }
+
+    const uint8_t* pChunk = m_pData + DATASET_HEADER_SIZE + chunk * DATASET_CHUNK_SIZE;
+    const uint8_t* pMove = &pChunk[MOVE_COLUMN + index * DATASET_MOVE_SIZE];
+    uint32_t move = pMove[0] | (pMove[1] << 8) | ((uint32_t)pMove[2] << 16);
+
+    pRecord->pBoard = &pChunk[BOARD_COLUMN + index * PACKED_BOARD_SIZE];
+    pRecord->type = static_cast<TetrominoType>(move & 0x07);
+    pRecord->rotation = static_cast<TetrominoRotation>((move >> 3) & 0x03);
+    pRecord->x = (move >> 5) & 0x0F;
+    pRecord->y = (move >> 9) & 0x1F;
+    pRecord->lines = (move >> 14) & 0x07;
+
+    return true;
+}
@@ -1,347 +1,643 @@
-/*
-TETRIS for ESP32 with SSD1306 OLED display
-
-MIT License
-
-Copyright (c) 2025 Lorenzo Monti
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-#include "game.h"
-#include "joystick.h"
-#include "tetromino.h"
-
-const uint32_t FALLING_SPEED = 400; // milliseconds
-
-Game::Game(Joystick* pJoystick, Adafruit_SSD1306* pDisplay)
-: m_pJoystick(pJoystick), m_pDisplay(pDisplay) {
-}
-
-Game::~Game() {
-}
-
-bool Game::begin() {
-    return true;
-}
-
-void Game::clear() {
-    for (int i = 0; i < BOARD_HEIGHT; i++) {
-        for (int j = 0; j < BOARD_WIDTH; j++) {
-            m_Board[i][j] = false;
-        }
-    }
-}
-
-void Game::waitCoins() {
-    m_pJoystick->enable();
-
-    render(RENDER_MODE_INSERT_COINS);
-    m_pJoystick->waitMove(portMAX_DELAY); // wait for a button press
-}
-
-void Game::playMatch() {
-    m_pJoystick->enable();
-    
-    clear();
-
-    for (;;) {
-        // try to place a new tetromino
-        // if it overlaps, game over
-        if (newTetromino()) {
-            render(RENDER_MODE_PLAYING);
-
-            uint32_t timeLeft = FALLING_SPEED; // the time left for the tetromino to fall
-
-            for (;;) {
-                bool moved = false, landed = false, fallen = false;
-
-                uint32_t startTime = millis();
-
-                Joystick::Button button = m_pJoystick->waitMove(timeLeft);
-
-                switch (button) {
-                    case Joystick::BUTTON_LEFT:
-                        moved = moveTetromino(-1);
-                        break;
-                    case Joystick::BUTTON_RIGHT:
-                        moved = moveTetromino(1);
-                        break;
-                    case Joystick::BUTTON_ROTATE:
-                        moved = rotateTetromino();
-                        break;
-                    default:
-                        fallen = true;
-                        landed = !moveTetromino(0, -1); // if it can't move down, it has landed
-                        timeLeft = FALLING_SPEED;
-                        break;
-                }
-
-                if (fallen || landed || moved) {
-                    // something changed on the screen, redraw needed
-                    render(RENDER_MODE_PLAYING);
-                }
-                
-                if (!fallen) {
-                    // if the tetromino hasn't fallen yet, calculate the time left for another move
-                    uint32_t endTime = millis();
-
-                    uint32_t elapsedTime = endTime - startTime;
-                    if (timeLeft > elapsedTime) {
-                        timeLeft -= elapsedTime;
-                    } else {
-                        timeLeft = 0;
-                    }
-
-                    Serial.printf("Time left: %dms\n", timeLeft);
-                }
-
-                if (landed) {
-                    Serial.printf("X=%d Y=%d - tetromino landed!\n", m_TetrominoX, m_TetrominoY);
-                    placeTetromino(); // place the tetromino on the board
-                    break;
-                }
-            }
-
-            removeCompletedRows();
-        } else {
-            return;
-        }
-    }
-}
-
-void Game::over() {
-    m_pJoystick->enable();
-
-    render(RENDER_MODE_GAME_OVER);
-    m_pJoystick->waitMove(portMAX_DELAY); // wait for a button press
-
-    m_pJoystick->disable();
-}
-
-void Game::render(RenderMode mode) {
-    m_pDisplay->clearDisplay();
-
-    // game board border
-    m_pDisplay->drawFastVLine(0, 0, PLAYSCREEN_HEIGHT, SSD1306_WHITE);
-    m_pDisplay->drawFastVLine(PLAYSCREEN_WIDTH - 1, 0, PLAYSCREEN_HEIGHT, SSD1306_WHITE);
-
-    switch (mode) {
-        case RENDER_MODE_INSERT_COINS:
-            m_pDisplay->setTextSize(2);
-            m_pDisplay->setCursor(15, 20);
-            m_pDisplay->print(F("INS"));
-            m_pDisplay->setCursor(15, 40);
-            m_pDisplay->print(F("ERT"));
-            m_pDisplay->setCursor(21, 60);
-            m_pDisplay->print(F("CO"));
-            m_pDisplay->setCursor(15, 80);
-            m_pDisplay->print(F("INS"));
-            break;
-
-        case RENDER_MODE_PLAYING:
-            // draw the game board
-            for (int i = 0; i < BOARD_HEIGHT; i++) {
-                for (int j = 0; j < BOARD_WIDTH; j++) {
-                    if (m_Completed[i]) {
-                        // we're going to remove this row, so draw some dots to simulate an explosion
-                        m_pDisplay->drawPixel(LEFT_MARGIN + (j * BLOCK_WIDTH) + (BLOCK_WIDTH / 2), PLAYSCREEN_HEIGHT - (i * BLOCK_HEIGHT) - (BLOCK_HEIGHT / 2), SSD1306_WHITE);
-                    } else if (m_Board[i][j]) {
-                        m_pDisplay->fillRect(LEFT_MARGIN + (j * BLOCK_WIDTH), PLAYSCREEN_HEIGHT - ((i + 1) * BLOCK_HEIGHT), BLOCK_WIDTH, BLOCK_HEIGHT, SSD1306_WHITE);
-                    }
-                }
-            }
-            
-            // draw the falling tetromino
-            // m_pTetromino is NULL if the tetromino has landed
-            if (m_pTetromino) {
-                for (int i = 0; i < 4; i++) {
-                    assert(!m_Completed[i]);
-                    int8_t x = m_TetrominoX + m_pTetromino->blocks[i].x;
-                    int8_t y = m_TetrominoY + m_pTetromino->blocks[i].y;
-                    m_pDisplay->fillRect(LEFT_MARGIN + (x * BLOCK_WIDTH), PLAYSCREEN_HEIGHT - ((y + 1) * BLOCK_HEIGHT), BLOCK_WIDTH, BLOCK_HEIGHT, SSD1306_WHITE);
-                }
-
-                // falling hint - left boundary
-                for (int i = m_TetrominoY + m_pTetromino->leftboundary.y - 1; i >= 0; i--) {
-                    int8_t x = m_TetrominoX + m_pTetromino->leftboundary.x;
-                    m_pDisplay->drawPixel(LEFT_MARGIN + (x * BLOCK_WIDTH), PLAYSCREEN_HEIGHT - (i * BLOCK_HEIGHT) - (BLOCK_HEIGHT / 2), SSD1306_WHITE);
-                    if (i == 0 || m_Board[i][x])
-                        break;
-                }
-
-                // falling hint - right boundary
-                for (int i = m_TetrominoY + m_pTetromino->rightboundary.y - 1; i >= 0; i--) {
-                    int8_t x = m_TetrominoX + m_pTetromino->rightboundary.x + 1;
-                    m_pDisplay->drawPixel(LEFT_MARGIN + (x * BLOCK_WIDTH) - 1, PLAYSCREEN_HEIGHT - (i * BLOCK_HEIGHT) - (BLOCK_HEIGHT / 2), SSD1306_WHITE);
-                    if (i == 0 || m_Board[i][x - 1])
-                        break;
-                }
-            }
-            break;
-
-        case RENDER_MODE_GAME_OVER:
-            m_pDisplay->setTextSize(2);
-            m_pDisplay->setCursor(9, 30);
-            m_pDisplay->print(F("GAME"));
-            m_pDisplay->setCursor(9, 60);
-            m_pDisplay->print(F("OVER"));
-            break;
-
-        default:
-            break;
-    }
-
-    m_pDisplay->display();
-}
-
-bool Game::newTetromino() {
-    m_TetrominoX = BOARD_WIDTH / 2 - 1;
-    m_TetrominoY = BOARD_HEIGHT - 1;
-    m_TetrominoType = static_cast<TetrominoType>(random(0, TETROMINO_COUNT));
-    m_TetrominoRotation = ROTATION_0;
-    m_pTetromino = &(Pieces[m_TetrominoType][m_TetrominoRotation]);
-
-    return !tetrominoOverlaps(); // if it overlaps, game over
-}
-
-// deltaX and deltaY allow us to check for overlaps befor the move takes place
-// pTetromino is used to check for overlaps when rotating the tetromino
-bool Game::tetrominoOverlaps(const Tetromino* pTetromino, int8_t deltaX, int8_t deltaY) {
-    if (pTetromino == NULL) {
-        pTetromino = m_pTetromino;
-    }
-
-    assert(pTetromino != NULL);
-
-    for (int i = 0; i < 4; i++) {
-        int8_t x = m_TetrominoX + pTetromino->blocks[i].x + deltaX;
-        int8_t y = m_TetrominoY + pTetromino->blocks[i].y + deltaY;
-
-        assert(y < BOARD_HEIGHT);
-
-        if (x < 0 || x >= BOARD_WIDTH || y < 0) {
-            return true;
-        }
-
-        if (m_Board[y][x]) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-void Game::placeTetromino() {
-    assert(m_pTetromino != NULL);
-
-    for (int i = 0; i < 4; i++) {
-        int8_t x = m_TetrominoX + m_pTetromino->blocks[i].x;
-        int8_t y = m_TetrominoY + m_pTetromino->blocks[i].y;
-
-        assert(x >= 0 && x < BOARD_WIDTH);
-        assert(y >= 0 && y < BOARD_HEIGHT);
-
-        m_Board[y][x] = true;
-    }
-
-    m_pTetromino = NULL;
-}
-
-bool Game::moveTetromino(int8_t deltaX, int8_t deltaY) {
-    assert(m_pTetromino != NULL);
-
-    if (tetrominoOverlaps(m_pTetromino, deltaX, deltaY)) {
-        return false;
-    }
-    
-    m_TetrominoX += deltaX;
-    m_TetrominoY += deltaY;
-
-    return true;
-}
-
-bool Game::rotateTetromino() {
-    // pointer to the next rotation of the tetromino
-    const Tetromino* pTetromino = &(Pieces[m_TetrominoType][(m_TetrominoRotation + 1) % ROTATION_COUNT]);
-
-    // would the rotated tetromino overlap?
-    if (tetrominoOverlaps(pTetromino)) {
-        return false;
-    }
-
-    m_TetrominoRotation = static_cast<TetrominoRotation>((m_TetrominoRotation + 1) % ROTATION_COUNT);
-    m_pTetromino = pTetromino;
-
-    return true;
-}
-
-void Game::removeCompletedRows() {
-    if (clearCompletedRows()) {
-        m_pJoystick->disable(); // we don't accept any input while the rows are being removed
-
-        render(RENDER_MODE_PLAYING); // draw the game board. The completed rows are drawn using dots
-        
-        delay(200);
-        compactBoard(); // remove the completed rows
-        
-        render(RENDER_MODE_PLAYING); // draw the game board again
-        
-        m_pJoystick->enable(); // enable input again
-    }
-}
-
-bool Game::clearCompletedRows() {
-    bool hasCompletedRows = false;
-
-    for (int i = 0; i < BOARD_HEIGHT; i++) {
-        m_Completed[i] = true;
-
-        for (int j = 0; j < BOARD_WIDTH; j++) {
-            if (!m_Board[i][j]) {
-                m_Completed[i] = false;
-                break;
-            }
-        }
-
-        hasCompletedRows = hasCompletedRows || m_Completed[i];
-    }
-
-    return hasCompletedRows;
-}
-
-void Game::compactBoard() {
-    for (int i = BOARD_HEIGHT - 1; i >= 0; i--) {
-        if (m_Completed[i]) {
-            // move all rows above the completed row down by one
-            for (int j = i; j < BOARD_HEIGHT - 1; j++) {
-                for (int k = 0; k < BOARD_WIDTH; k++) {
-                    m_Board[j][k] = m_Board[j + 1][k];
-                }
-            }
-
-            // clear the topmost row
-            for (int k = 0; k < BOARD_WIDTH; k++) {
-                m_Board[BOARD_HEIGHT - 1][k] = false;
-            }
-
-            // mark the completed row as not completed anymore
-            m_Completed[i] = false;
-        }
-    }
-}
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "dataset.h"
+#include "game.h"
+#include "hint.h"
+#include "joystick.h"
+#include "power.h"
+#include "sequencer.h"
+#include "tetromino.h"
+#include "versus.h"
+
+Game::Game(Joystick* pJoystick, Renderer* pRenderer)
+: m_pJoystick(pJoystick), m_pRenderer(pRenderer), m_pVersus(NULL), m_pSequencer(NULL), m_pRecorder(NULL), m_pHint(NULL), m_pPower(NULL), m_bWon(false) {
+}
+
+Game::~Game() {
+}
+
+bool Game::begin() {
+    seed(((uint64_t)esp_random() << 32) | esp_random()); // a different game at every boot
+
+    return true;
+}
+
+void Game::seed(uint64_t seed, uint32_t stream) {
+    m_Pieces.seed(seed, stream);
+    m_Garbage = RandomStream(seed, stream).split(1);
+}
+
+void Game::clear() {
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            m_Board[i][j] = false;
+        }
+
+        m_Completed[i] = false;
+    }
+
+    m_pTetromino = NULL;
+    m_HeldType = TETROMINO_COUNT;
+}
+
+void Game::showInsertCoins() {
+    render(RENDER_MODE_INSERT_COINS);
+}
+
+void Game::waitCoins() {
+    m_pJoystick->enable();
+
+    if (m_pPower) {
+        m_pPower->enter(PowerManager::STATE_ATTRACT);
+    }
+
+    render(RENDER_MODE_INSERT_COINS);
+    waitButton();
+}
+
+// blocks until a button is pressed, asleep if possible
+void Game::waitButton() {
+    // a hint completed after the match is not a press either
+    if (!m_pPower) {
+        while (m_pJoystick->waitMove(portMAX_DELAY) == Joystick::BUTTON_REDRAW) {
+        }
+        return;
+    }
+
+    // a wakeup is not a press yet: a bounce or a glitch sends us back to sleep
+    Joystick::Button button;
+
+    do {
+        m_pPower->idle();
+
+        while ((button = m_pJoystick->waitMove(POWER_PRESS_TIMEOUT)) == Joystick::BUTTON_REDRAW) {
+        }
+    } while (button == Joystick::BUTTON_NONE);
+}
+
+void Game::playMatch() {
+    m_pJoystick->enable();
+    
+    clear();
+
+    if (m_pPower) {
+        m_pPower->enter(PowerManager::STATE_PLAYING);
+    }
+
+    m_bWon = false;
+
+    if (m_pVersus) {
+        m_pVersus->reset();
+    }
+
+    if (m_pSequencer) {
+        m_pSequencer->post(Sequencer::COMMAND_PLAY_MUSIC);
+    }
+
+    for (;;) {
+        // try to place a new tetromino
+        // if it overlaps, game over
+        if (newTetromino()) {
+            requestHint();
+            render(RENDER_MODE_PLAYING);
+
+            uint32_t timeLeft = FALLING_SPEED; // the time left for the tetromino to fall
+            uint8_t board[PACKED_BOARD_SIZE]; // the board before the tetromino landed, for the recorder
+            bool locking = false; // resting on the stack, waiting for the lock delay
+            uint8_t lockResets = 0;
+
+            for (;;) {
+                bool moved = false, landed = false, fallen = false, redraw = false;
+
+                uint32_t startTime = millis();
+
+                Joystick::Button button = m_pJoystick->waitMove(timeLeft);
+
+                if (m_pVersus) {
+                    m_pVersus->poll();
+
+                    if (m_pVersus->opponentToppedOut()) {
+                        m_bWon = true;
+                        return;
+                    }
+                }
+
+                bool held = false;
+
+                switch (button) {
+                    case Joystick::BUTTON_LEFT:
+                    case Joystick::BUTTON_RIGHT:
+                        // hold is LEFT and RIGHT pressed together
+                        if (Rules::Hold::ENABLED && m_pJoystick->isPressed(Joystick::BUTTON_LEFT) && m_pJoystick->isPressed(Joystick::BUTTON_RIGHT)) {
+                            held = holdTetromino();
+                        } else {
+                            moved = moveTetromino((button == Joystick::BUTTON_LEFT) ? -1 : 1);
+                        }
+                        break;
+                    case Joystick::BUTTON_ROTATE:
+                        moved = rotateTetromino();
+                        break;
+                    case Joystick::BUTTON_REDRAW:
+                        redraw = true; // a hint came in
+                        break;
+                    default:
+                        fallen = true;
+
+                        if (moveTetromino(0, -1)) {
+                            locking = false;
+                            timeLeft = FALLING_SPEED;
+                        } else if (Rules::Lock::DELAY == 0 || locking) {
+                            landed = true; // if it can't move down, it has landed
+                        } else {
+                            locking = true; // a last chance to slide or rotate
+                            timeLeft = Rules::Lock::DELAY;
+                        }
+                        break;
+                }
+
+                if (held) {
+                    // a new tetromino at the top, with a fall of its own
+                    timeLeft = FALLING_SPEED;
+                    locking = false;
+                    lockResets = 0;
+
+                    requestHint();
+                    render(RENDER_MODE_PLAYING);
+                    continue;
+                }
+
+                if ((fallen && !landed) || moved) {
+                    requestHint(); // the search starts over from the new position
+                }
+
+                if (fallen || landed || moved || redraw) {
+                    // something changed on the screen, redraw needed
+                    render(RENDER_MODE_PLAYING);
+                }
+                
+                if (!fallen) {
+                    // if the tetromino hasn't fallen yet, calculate the time left for another move
+                    uint32_t endTime = millis();
+
+                    uint32_t elapsedTime = endTime - startTime;
+                    if (timeLeft > elapsedTime) {
+                        timeLeft -= elapsedTime;
+                    } else {
+                        timeLeft = 0;
+                    }
+
+                    Serial.printf("Time left: %dms\n", timeLeft);
+                }
+
+                if (moved && locking && lockResets < Rules::Lock::RESETS) {
+                    lockResets++;
+                    timeLeft = Rules::Lock::DELAY;
+                }
+
+                if (landed) {
+                    Serial.printf("X=%d Y=%d - tetromino landed!\n", m_TetrominoX, m_TetrominoY);
+
+                    if (m_pRecorder) {
+                        packBoard(board);
+                    }
+
+                    placeTetromino(); // place the tetromino on the board
+
+                    if (m_pSequencer) {
+                        m_pSequencer->post(Sequencer::COMMAND_EFFECT_LANDING);
+                    }
+                    break;
+                }
+            }
+
+            uint8_t lines = removeCompletedRows();
+
+            if (m_pRecorder) {
+                m_pRecorder->add(board, m_TetrominoType, m_TetrominoRotation, m_TetrominoX, m_TetrominoY, lines);
+            }
+
+            if (m_pVersus) {
+                // garbage goes in as part of the same step, so the opponent mirror can replay it exactly
+                uint8_t garbage = m_pVersus->takeGarbage();
+                uint8_t hole = m_Garbage.below(BOARD_WIDTH);
+
+                if (garbage > 0) {
+                    addGarbage(garbage, hole);
+                    render(RENDER_MODE_PLAYING);
+                }
+
+                m_pVersus->pieceLocked(m_TetrominoType, m_TetrominoRotation, m_TetrominoX, m_TetrominoY, garbage, hole);
+                m_pVersus->linesCleared(lines);
+            }
+        } else {
+            if (m_pVersus) {
+                m_pVersus->toppedOut();
+            }
+
+            return;
+        }
+    }
+}
+
+void Game::over() {
+    m_pJoystick->enable();
+
+    if (m_pPower) {
+        m_pPower->enter(PowerManager::STATE_GAME_OVER);
+    }
+
+    if (m_pRecorder) {
+        m_pRecorder->flush(); // the records of this match are safe, even if the power goes off
+        Serial.printf("Recorder: %u records\n", m_pRecorder->records());
+    }
+
+    if (m_pSequencer) {
+        m_pSequencer->post(Sequencer::COMMAND_STOP_MUSIC);
+        m_pSequencer->post(Sequencer::COMMAND_EFFECT_GAME_OVER);
+        m_pSequencer->report();
+    }
+
+    m_pRenderer->report();
+
+    if (m_pVersus) {
+        m_pVersus->report();
+    }
+
+    if (m_pHint) {
+        m_pHint->report();
+    }
+
+    if (m_pPower) {
+        m_pPower->report();
+    }
+
+    render(m_bWon ? RENDER_MODE_YOU_WIN : RENDER_MODE_GAME_OVER);
+    waitButton();
+
+    m_pJoystick->disable();
+}
+
+void Game::render(RenderMode mode) {
+    Adafruit_GFX* pGfx = m_pRenderer->gfx();
+
+    m_pRenderer->clear();
+
+    // game board border
+    pGfx->drawFastVLine(0, 0, PLAYSCREEN_HEIGHT, SSD1306_WHITE);
+    pGfx->drawFastVLine(PLAYSCREEN_WIDTH - 1, 0, PLAYSCREEN_HEIGHT, SSD1306_WHITE);
+
+    switch (mode) {
+        case RENDER_MODE_INSERT_COINS:
+            pGfx->setTextSize(2);
+            pGfx->setCursor(15, 20);
+            pGfx->print(F("INS"));
+            pGfx->setCursor(15, 40);
+            pGfx->print(F("ERT"));
+            pGfx->setCursor(21, 60);
+            pGfx->print(F("CO"));
+            pGfx->setCursor(15, 80);
+            pGfx->print(F("INS"));
+            break;
+
+        case RENDER_MODE_PLAYING:
+            // draw the game board
+            for (int i = 0; i < BOARD_HEIGHT; i++) {
+                for (int j = 0; j < BOARD_WIDTH; j++) {
+                    if (m_Completed[i]) {
+                        // we're going to remove this row, so draw some dots to simulate an explosion
+                        pGfx->drawPixel(LEFT_MARGIN + (j * BLOCK_WIDTH) + (BLOCK_WIDTH / 2), PLAYSCREEN_HEIGHT - (i * BLOCK_HEIGHT) - (BLOCK_HEIGHT / 2), SSD1306_WHITE);
+                    } else if (m_Board[i][j]) {
+                        pGfx->fillRect(LEFT_MARGIN + (j * BLOCK_WIDTH), PLAYSCREEN_HEIGHT - ((i + 1) * BLOCK_HEIGHT), BLOCK_WIDTH, BLOCK_HEIGHT, SSD1306_WHITE);
+                    }
+                }
+            }
+            
+            // draw the falling tetromino
+            // m_pTetromino is NULL if the tetromino has landed
+            if (m_pTetromino) {
+                for (int i = 0; i < 4; i++) {
+                    assert(!m_Completed[i]);
+                    int8_t x = m_TetrominoX + m_pTetromino->blocks[i].x;
+                    int8_t y = m_TetrominoY + m_pTetromino->blocks[i].y;
+                    pGfx->fillRect(LEFT_MARGIN + (x * BLOCK_WIDTH), PLAYSCREEN_HEIGHT - ((y + 1) * BLOCK_HEIGHT), BLOCK_WIDTH, BLOCK_HEIGHT, SSD1306_WHITE);
+                }
+
+                // placement hint: ghost outline of the best landing spot found so far
+                int8_t hintX, hintY;
+                TetrominoRotation hintRotation;
+
+                if (m_pHint && m_pHint->result(&hintX, &hintY, &hintRotation)) {
+                    const Tetromino* pGhost = &(Pieces[m_TetrominoType][hintRotation]);
+
+                    for (int i = 0; i < 4; i++) {
+                        int8_t x = hintX + pGhost->blocks[i].x;
+                        int8_t y = hintY + pGhost->blocks[i].y;
+                        pGfx->drawRect(LEFT_MARGIN + (x * BLOCK_WIDTH), PLAYSCREEN_HEIGHT - ((y + 1) * BLOCK_HEIGHT), BLOCK_WIDTH, BLOCK_HEIGHT, SSD1306_WHITE);
+                    }
+                }
+
+                // falling hint - left boundary
+                for (int i = m_TetrominoY + m_pTetromino->leftboundary.y - 1; i >= 0; i--) {
+                    int8_t x = m_TetrominoX + m_pTetromino->leftboundary.x;
+                    pGfx->drawPixel(LEFT_MARGIN + (x * BLOCK_WIDTH), PLAYSCREEN_HEIGHT - (i * BLOCK_HEIGHT) - (BLOCK_HEIGHT / 2), SSD1306_WHITE);
+                    if (i == 0 || m_Board[i][x])
+                        break;
+                }
+
+                // falling hint - right boundary
+                for (int i = m_TetrominoY + m_pTetromino->rightboundary.y - 1; i >= 0; i--) {
+                    int8_t x = m_TetrominoX + m_pTetromino->rightboundary.x + 1;
+                    pGfx->drawPixel(LEFT_MARGIN + (x * BLOCK_WIDTH) - 1, PLAYSCREEN_HEIGHT - (i * BLOCK_HEIGHT) - (BLOCK_HEIGHT / 2), SSD1306_WHITE);
+                    if (i == 0 || m_Board[i][x - 1])
+                        break;
+                }
+            }
+
+            // the held tetromino, in miniature in the rows left above the board
+            if (Rules::Hold::ENABLED && m_HeldType != TETROMINO_COUNT) {
+                const Tetromino* pHeld = &(Pieces[m_HeldType][ROTATION_0]);
+
+                for (int i = 0; i < 4; i++) {
+                    int8_t x = pHeld->blocks[i].x + 1; // 0 to 3
+                    int8_t y = -pHeld->blocks[i].y; // 0 or 1, from the top
+                    pGfx->fillRect(LEFT_MARGIN + (x * HELD_BLOCK_WIDTH), y, HELD_BLOCK_WIDTH, 1, SSD1306_WHITE);
+                }
+            }
+            break;
+
+        case RENDER_MODE_GAME_OVER:
+            pGfx->setTextSize(2);
+            pGfx->setCursor(9, 30);
+            pGfx->print(F("GAME"));
+            pGfx->setCursor(9, 60);
+            pGfx->print(F("OVER"));
+            break;
+
+        case RENDER_MODE_YOU_WIN:
+            pGfx->setTextSize(2);
+            pGfx->setCursor(15, 30);
+            pGfx->print(F("YOU"));
+            pGfx->setCursor(15, 60);
+            pGfx->print(F("WIN"));
+            break;
+
+        default:
+            break;
+    }
+
+    m_pRenderer->present();
+}
+
+bool Game::newTetromino() {
+    m_bHoldUsed = false;
+
+    return spawnTetromino(m_Pieces.next());
+}
+
+bool Game::spawnTetromino(TetrominoType type) {
+    m_TetrominoX = BOARD_WIDTH / 2 - 1;
+    m_TetrominoY = BOARD_HEIGHT - 1;
+    m_TetrominoType = type;
+    m_TetrominoRotation = ROTATION_0;
+    m_pTetromino = &(Pieces[m_TetrominoType][m_TetrominoRotation]);
+
+    return !tetrominoOverlaps(); // if it overlaps, game over
+}
+
+// swaps the falling tetromino with the held one, or with the next one if none is held
+bool Game::holdTetromino() {
+    if (m_bHoldUsed) {
+        return false;
+    }
+
+    TetrominoType type = (m_HeldType != TETROMINO_COUNT) ? m_HeldType : m_Pieces.peek();
+
+    if (tetrominoOverlaps(&(Pieces[type][ROTATION_0]), BOARD_WIDTH / 2 - 1 - m_TetrominoX, BOARD_HEIGHT - 1 - m_TetrominoY)) {
+        return false; // no room at the top
+    }
+
+    if (m_HeldType == TETROMINO_COUNT) {
+        m_Pieces.next();
+    }
+
+    m_HeldType = m_TetrominoType;
+    m_bHoldUsed = true;
+
+    return spawnTetromino(type);
+}
+
+// deltaX and deltaY allow us to check for overlaps befor the move takes place
+// pTetromino is used to check for overlaps when rotating the tetromino
+bool Game::tetrominoOverlaps(const Tetromino* pTetromino, int8_t deltaX, int8_t deltaY) {
+    if (pTetromino == NULL) {
+        pTetromino = m_pTetromino;
+    }
+
+    assert(pTetromino != NULL);
+
+    for (int i = 0; i < 4; i++) {
+        int8_t x = m_TetrominoX + pTetromino->blocks[i].x + deltaX;
+        int8_t y = m_TetrominoY + pTetromino->blocks[i].y + deltaY;
+
+        assert(y < BOARD_HEIGHT);
+
+        if (x < 0 || x >= BOARD_WIDTH || y < 0) {
+            return true;
+        }
+
+        if (m_Board[y][x]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Game::placeTetromino() {
+    assert(m_pTetromino != NULL);
+
+    for (int i = 0; i < 4; i++) {
+        int8_t x = m_TetrominoX + m_pTetromino->blocks[i].x;
+        int8_t y = m_TetrominoY + m_pTetromino->blocks[i].y;
+
+        assert(x >= 0 && x < BOARD_WIDTH);
+        assert(y >= 0 && y < BOARD_HEIGHT);
+
+        m_Board[y][x] = true;
+    }
+
+    m_pTetromino = NULL;
+}
+
+bool Game::moveTetromino(int8_t deltaX, int8_t deltaY) {
+    assert(m_pTetromino != NULL);
+
+    if (tetrominoOverlaps(m_pTetromino, deltaX, deltaY)) {
+        return false;
+    }
+    
+    m_TetrominoX += deltaX;
+    m_TetrominoY += deltaY;
+
+    return true;
+}
+
+bool Game::rotateTetromino() {
+    // pointer to the next rotation of the tetromino
+    const Tetromino* pTetromino = &(Pieces[m_TetrominoType][(m_TetrominoRotation + 1) % ROTATION_COUNT]);
+
+    // try the offsets of the rotation system in order, the first one is always in place
+    // with plain rotation the loop runs once on a constant offset of zero, as if it was not there
+    for (uint8_t i = 0; i < Rules::Rotation::KICKS; i++) {
+        Point kick = Rules::Rotation::kick(m_TetrominoType, m_TetrominoRotation, i);
+
+        // a kick never lifts the tetromino above the spawn height, there is no board up there
+        if (m_TetrominoY + kick.y >= BOARD_HEIGHT) {
+            continue;
+        }
+
+        // would the rotated tetromino overlap?
+        if (tetrominoOverlaps(pTetromino, kick.x, kick.y)) {
+            continue;
+        }
+
+        m_TetrominoX += kick.x;
+        m_TetrominoY += kick.y;
+        m_TetrominoRotation = static_cast<TetrominoRotation>((m_TetrominoRotation + 1) % ROTATION_COUNT);
+        m_pTetromino = pTetromino;
+
+        return true;
+    }
+
+    return false;
+}
+
+uint8_t Game::removeCompletedRows() {
+    uint8_t lines = 0;
+
+    if (clearCompletedRows()) {
+        for (int i = 0; i < BOARD_HEIGHT; i++) {
+            if (m_Completed[i]) {
+                lines++;
+            }
+        }
+
+        m_pJoystick->disable(); // we don't accept any input while the rows are being removed
+
+        if (m_pSequencer) {
+            m_pSequencer->post(Sequencer::COMMAND_EFFECT_LINE_CLEAR);
+        }
+
+        render(RENDER_MODE_PLAYING); // draw the game board. The completed rows are drawn using dots
+        
+        delay(200);
+        compactBoard(); // remove the completed rows
+        
+        render(RENDER_MODE_PLAYING); // draw the game board again
+        
+        m_pJoystick->enable(); // enable input again
+    }
+
+    return lines;
+}
+
+bool Game::clearCompletedRows() {
+    bool hasCompletedRows = false;
+
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        m_Completed[i] = true;
+
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            if (!m_Board[i][j]) {
+                m_Completed[i] = false;
+                break;
+            }
+        }
+
+        hasCompletedRows = hasCompletedRows || m_Completed[i];
+    }
+
+    return hasCompletedRows;
+}
+
+void Game::compactBoard() {
+    for (int i = BOARD_HEIGHT - 1; i >= 0; i--) {
+        if (m_Completed[i]) {
+            // move all rows above the completed row down by one
+            for (int j = i; j < BOARD_HEIGHT - 1; j++) {
+                for (int k = 0; k < BOARD_WIDTH; k++) {
+                    m_Board[j][k] = m_Board[j + 1][k];
+                }
+            }
+
+            // clear the topmost row
+            for (int k = 0; k < BOARD_WIDTH; k++) {
+                m_Board[BOARD_HEIGHT - 1][k] = false;
+            }
+
+            // mark the completed row as not completed anymore
+            m_Completed[i] = false;
+        }
+    }
+}
+
+// push the whole board up and fill the bottom rows, leaving a single hole in each of them
+// anything pushed past the top row is lost
+void Game::addGarbage(uint8_t lines, uint8_t hole) {
+    assert(lines <= BOARD_HEIGHT);
+    assert(hole < BOARD_WIDTH);
+
+    for (int i = BOARD_HEIGHT - 1; i >= lines; i--) {
+        for (int k = 0; k < BOARD_WIDTH; k++) {
+            m_Board[i][k] = m_Board[i - lines][k];
+        }
+    }
+
+    for (int i = 0; i < lines; i++) {
+        for (int k = 0; k < BOARD_WIDTH; k++) {
+            m_Board[i][k] = (k != hole);
+        }
+    }
+}
+
+void Game::packBoard(uint8_t* pData) const {
+    memset(pData, 0, PACKED_BOARD_SIZE);
+
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            if (m_Board[i][j]) {
+                int bit = i * BOARD_WIDTH + j;
+                pData[bit / 8] |= 1 << (bit % 8);
+            }
+        }
+    }
+}
+
+void Game::requestHint() {
+    if (m_pHint) {
+        m_pHint->request(m_Board, m_TetrominoType, m_TetrominoY);
+    }
+}
@@ -0,0 +1,256 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "hint.h"
+
+#define FULL_ROW ((1 << BOARD_WIDTH) - 1)
+
+#define RESULT_VALID 0x80000000
+#define RESULT_GENERATION(result) ((result) & 0xFFFF)
+
+// weights of the board evaluation, the higher the score the better
+#define WEIGHT_HEIGHT -51
+#define WEIGHT_LINES 76
+#define WEIGHT_HOLES -36
+#define WEIGHT_BUMPINESS -18
+
+HintEngine::HintEngine(Joystick* pJoystick)
+: m_pJoystick(pJoystick), m_Generation(0), m_Result(0), m_Task(NULL),
+  m_Searches(0), m_Cancelled(0), m_SearchMicros(0), m_MaxSearchMicros(0) {
+}
+
+HintEngine::~HintEngine() {
+}
+
+bool HintEngine::begin() {
+    return xTaskCreatePinnedToCore(searchTask, "Hint Task", HINT_STACK, this, HINT_PRIORITY, &m_Task, HINT_CORE) == pdPASS;
+}
+
+void HintEngine::request(const bool board[BOARD_HEIGHT][BOARD_WIDTH], TetrominoType type, int8_t y) {
+    uint32_t generation = m_Generation.load(std::memory_order_relaxed) + 1;
+    HintRequest* pRequest = &m_Requests[generation & 1];
+
+    // the slot of two requests ago: our writes must not be seen before the last request was published
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        pRequest->rows[i] = 0;
+
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            if (board[i][j]) {
+                pRequest->rows[i] |= 1 << j;
+            }
+        }
+    }
+
+    pRequest->type = type;
+    pRequest->y = y;
+
+    m_Generation.store(generation, std::memory_order_release);
+    xTaskNotifyGive(m_Task);
+}
+
+bool HintEngine::result(int8_t* pX, int8_t* pY, TetrominoRotation* pRotation) const {
+    uint32_t result = m_Result.load(std::memory_order_acquire);
+
+    if (!(result & RESULT_VALID) || RESULT_GENERATION(result) != RESULT_GENERATION(m_Generation.load(std::memory_order_relaxed))) {
+        return false;
+    }
+
+    *pRotation = static_cast<TetrominoRotation>((result >> 16) & 0x03);
+    *pX = (int8_t)((result >> 18) & 0x0F) - 2; // stored with an offset: the I tetromino can stand at x = -1
+    *pY = (result >> 22) & 0x1F;
+
+    return true;
+}
+
+void HintEngine::report() {
+    uint32_t completed = m_Searches - m_Cancelled;
+
+    Serial.printf("Hint: %u searches, %u cancelled, %uus average, %uus max\n",
+        m_Searches, m_Cancelled, completed ? m_SearchMicros / completed : 0, m_MaxSearchMicros);
+}
+
+// returns false if a newer request came in before the search was over
+bool HintEngine::search() {
+    uint32_t startTime = micros();
+    uint32_t generation = m_Generation.load(std::memory_order_acquire);
+    HintRequest request = m_Requests[generation & 1];
+
+    m_Searches++;
+
+    // a seqlock read: the copy is done before the generation is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (cancelled(generation)) {
+        m_Cancelled++;
+        return false; // the request was overwritten while being copied
+    }
+
+    int32_t bestScore = INT32_MIN;
+    uint32_t best = 0;
+
+    for (int r = 0; r < ROTATION_COUNT; r++) {
+        const Tetromino* pTetromino = &(Pieces[request.type][r]);
+
+        for (int8_t x = -2; x < BOARD_WIDTH + 2; x++) {
+            if (cancelled(generation)) {
+                m_Cancelled++;
+                return false;
+            }
+
+            // only straight drops from the current height are considered
+            int8_t y = request.y;
+
+            if (!fits(request.rows, pTetromino, x, y)) {
+                continue;
+            }
+
+            while (fits(request.rows, pTetromino, x, y - 1)) {
+                y--;
+            }
+
+            uint16_t rows[BOARD_HEIGHT];
+            memcpy(rows, request.rows, sizeof(rows));
+
+            for (int i = 0; i < 4; i++) {
+                rows[y + pTetromino->blocks[i].y] |= 1 << (x + pTetromino->blocks[i].x);
+            }
+
+            int32_t score = evaluate(rows);
+
+            if (score > bestScore) {
+                bestScore = score;
+                best = RESULT_VALID | (r << 16) | ((x + 2) << 18) | (y << 22);
+            }
+        }
+    }
+
+    if (best != 0) {
+        m_Result.store(best | RESULT_GENERATION(generation), std::memory_order_release);
+        m_pJoystick->requestRedraw(); // the ghost is drawn by the game task
+    }
+
+    uint32_t elapsedTime = micros() - startTime;
+
+    m_SearchMicros += elapsedTime;
+    if (elapsedTime > m_MaxSearchMicros) {
+        m_MaxSearchMicros = elapsedTime;
+    }
+
+    return true;
+}
+
+bool HintEngine::cancelled(uint32_t generation) const {
+    return m_Generation.load(std::memory_order_acquire) != generation;
+}
+
+// same rules as Game::tetrominoOverlaps
+bool HintEngine::fits(const uint16_t* pRows, const Tetromino* pTetromino, int8_t x, int8_t y) {
+    for (int i = 0; i < 4; i++) {
+        int8_t bx = x + pTetromino->blocks[i].x;
+        int8_t by = y + pTetromino->blocks[i].y;
+
+        assert(by < BOARD_HEIGHT);
+
+        if (bx < 0 || bx >= BOARD_WIDTH || by < 0) {
+            return false;
+        }
+
+        if (pRows[by] & (1 << bx)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// aggregate height, completed lines, holes and bumpiness of the board after the placement
+int32_t HintEngine::evaluate(const uint16_t* pRows) {
+    int32_t lines = 0;
+    int32_t holes = 0;
+    int32_t aggregateHeight = 0;
+    int32_t bumpiness = 0;
+    int32_t previousHeight = -1;
+
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        if (pRows[i] == FULL_ROW) {
+            lines++;
+        }
+    }
+
+    for (int j = 0; j < BOARD_WIDTH; j++) {
+        int32_t height = 0;
+
+        // completed rows are going away, they don't count
+        for (int i = BOARD_HEIGHT - 1; i >= 0; i--) {
+            if (pRows[i] != FULL_ROW && (pRows[i] & (1 << j))) {
+                height = i + 1;
+                break;
+            }
+        }
+
+        for (int i = 0; i < height; i++) {
+            if (pRows[i] != FULL_ROW && !(pRows[i] & (1 << j))) {
+                holes++;
+            }
+        }
+
+        // the rows removed below the column top lower it
+        int32_t removed = 0;
+
+        for (int i = 0; i < height; i++) {
+            if (pRows[i] == FULL_ROW) {
+                removed++;
+            }
+        }
+
+        height -= removed;
+
+        aggregateHeight += height;
+
+        if (previousHeight >= 0) {
+            bumpiness += abs(height - previousHeight);
+        }
+
+        previousHeight = height;
+    }
+
+    return WEIGHT_HEIGHT * aggregateHeight + WEIGHT_LINES * lines + WEIGHT_HOLES * holes + WEIGHT_BUMPINESS * bumpiness;
+}
+
+void HintEngine::searchTask(void* pvParameters) {
+    HintEngine* pEngine = static_cast<HintEngine*>(pvParameters);
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // wait for a request
+
+        while (!pEngine->search()) {
+            // cancelled: start over with the newest request
+        }
+    }
+
+    vTaskDelete(NULL); // we should never get here
+}
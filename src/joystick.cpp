@@ -1,134 +1,200 @@
-/*
-TETRIS for ESP32 with SSD1306 OLED display
-
-MIT License
-
-Copyright (c) 2025 Lorenzo Monti
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-#include <Arduino.h>
-
-#include "joystick.h"
-
-typedef struct {
-    Joystick* pJoystick;
-    uint8_t pin;
-    EventBits_t button;
-} ButtonData;
-
-Joystick::Joystick()
-: m_bEnabled(false) {
-}
-
-Joystick::~Joystick() {
-}
-
-bool Joystick::begin() {
-    pinMode(PIN_BUTTON_LEFT, INPUT);
-    pinMode(PIN_BUTTON_RIGHT, INPUT);
-    pinMode(PIN_BUTTON_ROTATE, INPUT);
-
-    m_xPressed = xEventGroupCreate();
-
-    if (m_xPressed == NULL) {
-        return false;
-    }
-
-    static ButtonData buttonData[] = {
-        {this, PIN_BUTTON_LEFT, BIT_BUTTON_LEFT},
-        {this, PIN_BUTTON_RIGHT, BIT_BUTTON_RIGHT},
-        {this, PIN_BUTTON_ROTATE, BIT_BUTTON_ROTATE}
-    };
-
-    // create a task for each button
-    // each task receives a pointer to the button data structure
-    if (xTaskCreate(readButtonTask, "Button Task LEFT", 2048, &buttonData[0], 1, NULL) != pdPASS) {
-        return false;
-    }
-
-    if (xTaskCreate(readButtonTask, "Button Task RIGHT", 2048, &buttonData[1], 1, NULL) != pdPASS) {
-        return false;
-    }
-
-    if (xTaskCreate(readButtonTask, "Button Task ROTATE", 2048, &buttonData[2], 1, NULL) != pdPASS) {
-        return false;
-    }
-
-    return true;
-}
-
-void Joystick::readButtonTask(void* pvParameters) {
-    unsigned long debounceDelay = 20;
-    unsigned long lastDebounceTime = 0;
-    int buttonState;
-    int lastButtonState = HIGH;
-    ButtonData* pData = static_cast<ButtonData*>(pvParameters);
-
-    // debounce algorithm
-    for (;;) {
-        int reading = digitalRead(pData->pin);
-
-        if (reading != lastButtonState) {
-            lastDebounceTime = millis();
-        }
-
-        if ((millis() - lastDebounceTime) > debounceDelay) {
-            if (reading != buttonState) {
-                buttonState = reading;
-
-                if (buttonState == HIGH) {
-                    // button pressed
-                    pData->pJoystick->notifyButtonPressed(pData->button);
-                }
-            }
-        }
-
-        lastButtonState = reading;
-
-        delay(10);
-    }
-
-    vTaskDelete(NULL); // we should never get here
-}
-
-void Joystick::notifyButtonPressed(EventBits_t button) {
-    if (!m_bEnabled) {
-        return;
-    }
-
-    xEventGroupSetBits(m_xPressed, button);
-}
-
-Joystick::Button Joystick::waitMove(uint32_t timeout) {
-    Button button = BUTTON_NONE;
-    TickType_t xTicksToWait = timeout / portTICK_PERIOD_MS; // convert milliseconds to ticks
-
-    EventBits_t uxBits = xEventGroupWaitBits(m_xPressed, BITS_ALL_BUTTONS, pdTRUE, pdFALSE, xTicksToWait);
-
-    if (uxBits & BIT_BUTTON_LEFT) {
-        button = BUTTON_LEFT;
-    } else if (uxBits & BIT_BUTTON_RIGHT) {
-        button = BUTTON_RIGHT;
-    } else if (uxBits & BIT_BUTTON_ROTATE) {
-        button = BUTTON_ROTATE;
-    }
-
-    return button;
-}
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+
+#include "joystick.h"
+
+typedef struct {
+    Joystick* pJoystick;
+    uint8_t pin;
+    EventBits_t button;
+    const char* name;
+    TaskHandle_t hTask;
+} ButtonData;
+
+static ButtonData buttonData[] = {
+    {NULL, PIN_BUTTON_LEFT, BIT_BUTTON_LEFT, "Button Task LEFT", NULL},
+    {NULL, PIN_BUTTON_RIGHT, BIT_BUTTON_RIGHT, "Button Task RIGHT", NULL},
+    {NULL, PIN_BUTTON_ROTATE, BIT_BUTTON_ROTATE, "Button Task ROTATE", NULL}
+};
+
+#define BUTTON_DATA_COUNT (sizeof(buttonData) / sizeof(buttonData[0]))
+
+Joystick::Joystick()
+: m_bEnabled(false), m_Wakeups(0) {
+}
+
+Joystick::~Joystick() {
+}
+
+bool Joystick::begin() {
+    pinMode(PIN_BUTTON_LEFT, INPUT);
+    pinMode(PIN_BUTTON_RIGHT, INPUT);
+    pinMode(PIN_BUTTON_ROTATE, INPUT);
+
+    m_xPressed = xEventGroupCreate();
+
+    if (m_xPressed == NULL) {
+        return false;
+    }
+
+    // create a task for each button
+    // each task receives a pointer to the button data structure
+    // and sleeps until the pin interrupt tells it that the button is changing state
+    for (size_t i = 0; i < BUTTON_DATA_COUNT; i++) {
+        buttonData[i].pJoystick = this;
+
+        if (xTaskCreate(readButtonTask, buttonData[i].name, 2048, &buttonData[i], 1, &buttonData[i].hTask) != pdPASS) {
+            return false;
+        }
+
+        attachInterruptArg(buttonData[i].pin, onButtonChange, &buttonData[i], CHANGE);
+    }
+
+    return true;
+}
+
+bool Joystick::isPressed(Button button) const {
+    for (size_t i = 0; i < BUTTON_DATA_COUNT; i++) {
+        if (buttonData[i].button == ((EventBits_t)1 << button)) {
+            return digitalRead(buttonData[i].pin) == HIGH;
+        }
+    }
+
+    return false;
+}
+
+void Joystick::armWakeup() {
+    // the wakeup replaces the edge interrupt of the pin with a level one, until disarmWakeup()
+    // the interrupt is off meanwhile: a level interrupt fires again as long as the button is held
+    for (size_t i = 0; i < BUTTON_DATA_COUNT; i++) {
+        gpio_intr_disable(static_cast<gpio_num_t>(buttonData[i].pin));
+        gpio_wakeup_enable(static_cast<gpio_num_t>(buttonData[i].pin), GPIO_INTR_HIGH_LEVEL);
+    }
+
+    esp_sleep_enable_gpio_wakeup();
+}
+
+void Joystick::disarmWakeup() {
+    for (size_t i = 0; i < BUTTON_DATA_COUNT; i++) {
+        gpio_wakeup_disable(static_cast<gpio_num_t>(buttonData[i].pin));
+        gpio_set_intr_type(static_cast<gpio_num_t>(buttonData[i].pin), GPIO_INTR_ANYEDGE);
+        gpio_intr_enable(static_cast<gpio_num_t>(buttonData[i].pin));
+
+        xTaskNotifyGive(buttonData[i].hTask);
+    }
+}
+
+void IRAM_ATTR Joystick::onButtonChange(void* pArg) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    vTaskNotifyGiveFromISR(static_cast<ButtonData*>(pArg)->hTask, &xHigherPriorityTaskWoken);
+
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void Joystick::readButtonTask(void* pvParameters) {
+    unsigned long debounceDelay = JOYSTICK_DEBOUNCE;
+    unsigned long lastDebounceTime = 0;
+    int buttonState = LOW;
+    int lastButtonState = HIGH;
+    ButtonData* pData = static_cast<ButtonData*>(pvParameters);
+
+    // debounce algorithm
+    for (;;) {
+        int reading = digitalRead(pData->pin);
+
+        pData->pJoystick->m_Wakeups.fetch_add(1, std::memory_order_relaxed);
+
+        if (reading != lastButtonState) {
+            lastDebounceTime = millis();
+        }
+
+        if ((millis() - lastDebounceTime) > debounceDelay) {
+            if (reading != buttonState) {
+                buttonState = reading;
+
+                if (buttonState == HIGH) {
+                    // button pressed
+                    pData->pJoystick->notifyButtonPressed(pData->button);
+                }
+            }
+        }
+
+        lastButtonState = reading;
+
+        if (reading == buttonState) {
+            // stable: nothing to do until the pin changes again
+            // an edge since the read above has left a notification pending, so it is not lost
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        } else {
+            delay(JOYSTICK_POLL);
+        }
+    }
+
+    vTaskDelete(NULL); // we should never get here
+}
+
+void Joystick::notifyButtonPressed(EventBits_t button) {
+    if (!m_bEnabled) {
+        return;
+    }
+
+    xEventGroupSetBits(m_xPressed, button);
+}
+
+void Joystick::requestRedraw() {
+    xEventGroupSetBits(m_xPressed, BIT_REDRAW);
+}
+
+Joystick::Button Joystick::waitMove(uint32_t timeout) {
+    Button button = BUTTON_NONE;
+    TickType_t xTicksToWait = timeout / portTICK_PERIOD_MS; // convert milliseconds to ticks
+
+    EventBits_t uxBits = xEventGroupWaitBits(m_xPressed, BITS_ALL_BUTTONS | BIT_REDRAW, pdTRUE, pdFALSE, xTicksToWait);
+
+    m_Wakeups.fetch_add(1, std::memory_order_relaxed);
+
+    if (uxBits & BIT_BUTTON_LEFT) {
+        button = BUTTON_LEFT;
+    } else if (uxBits & BIT_BUTTON_RIGHT) {
+        button = BUTTON_RIGHT;
+    } else if (uxBits & BIT_BUTTON_ROTATE) {
+        button = BUTTON_ROTATE;
+    } else if (uxBits & BIT_REDRAW) {
+        button = BUTTON_REDRAW;
+    }
+
+    if (button != BUTTON_REDRAW && (uxBits & BIT_REDRAW)) {
+        xEventGroupSetBits(m_xPressed, BIT_REDRAW); // the button goes first, the redraw is for the next call
+    }
+
+    return button;
+}
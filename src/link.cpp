@@ -0,0 +1,193 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+
+#include "link.h"
+
+static const uint8_t BROADCAST_ADDRESS[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+Link::Link()
+: m_FramesDropped(0), m_BytesSent(0), m_BytesReceived(0) {
+}
+
+Link::~Link() {
+}
+
+bool Link::send(const uint8_t* pData, uint8_t length) {
+    assert(length > 0 && length <= LINK_MAX_FRAME);
+
+    if (!transmit(pData, length)) {
+        return false;
+    }
+
+    m_BytesSent += length;
+
+    return true;
+}
+
+uint8_t Link::receive(uint8_t* pData) {
+    uint8_t length = poll(pData);
+
+    m_BytesReceived += length;
+
+    return length;
+}
+
+LoopbackLink::LoopbackLink()
+: m_xFrames(NULL), m_pPeer(NULL), m_Delay(0), m_LossPercent(0) {
+}
+
+LoopbackLink::~LoopbackLink() {
+    if (m_xFrames != NULL) {
+        vQueueDelete(m_xFrames);
+    }
+}
+
+bool LoopbackLink::begin() {
+    m_xFrames = xQueueCreate(LINK_QUEUE_LENGTH, sizeof(LinkFrame));
+
+    return m_xFrames != NULL;
+}
+
+void LoopbackLink::setImpairment(uint32_t delay, uint8_t lossPercent, uint64_t seed) {
+    m_Delay = delay;
+    m_LossPercent = lossPercent;
+    m_Loss = RandomStream(seed);
+}
+
+bool LoopbackLink::transmit(const uint8_t* pData, uint8_t length) {
+    if (m_pPeer == NULL) {
+        return false;
+    }
+
+    // a lost frame still counts as sent, exactly like a radio would
+    if (m_LossPercent > 0 && m_Loss.below(100) < m_LossPercent) {
+        m_FramesDropped++;
+        return true;
+    }
+
+    LinkFrame frame;
+    frame.due = millis() + m_Delay;
+    frame.length = length;
+    memcpy(frame.data, pData, length);
+
+    if (!m_pPeer->deliver(&frame)) {
+        m_FramesDropped++; // peer queue full
+    }
+
+    return true;
+}
+
+bool LoopbackLink::deliver(const LinkFrame* pFrame) {
+    return xQueueSend(m_xFrames, pFrame, 0) == pdPASS;
+}
+
+uint8_t LoopbackLink::poll(uint8_t* pData) {
+    LinkFrame frame;
+
+    // the delay is the same for every frame, so the head of the queue is always the first one due
+    if (xQueuePeek(m_xFrames, &frame, 0) != pdPASS) {
+        return 0;
+    }
+
+    if ((int32_t)(millis() - frame.due) < 0) {
+        return 0; // still in flight
+    }
+
+    xQueueReceive(m_xFrames, &frame, 0);
+    memcpy(pData, frame.data, frame.length);
+
+    return frame.length;
+}
+
+QueueHandle_t EspNowLink::s_xFrames = NULL;
+
+EspNowLink::EspNowLink() {
+}
+
+EspNowLink::~EspNowLink() {
+}
+
+bool EspNowLink::begin() {
+    s_xFrames = xQueueCreate(LINK_QUEUE_LENGTH, sizeof(LinkFrame));
+
+    if (s_xFrames == NULL) {
+        return false;
+    }
+
+    WiFi.mode(WIFI_STA);
+
+    if (esp_now_init() != ESP_OK) {
+        return false;
+    }
+
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, BROADCAST_ADDRESS, ESP_NOW_ETH_ALEN);
+    peer.channel = 0; // current channel
+    peer.encrypt = false;
+
+    if (esp_now_add_peer(&peer) != ESP_OK) {
+        return false;
+    }
+
+    return esp_now_register_recv_cb(onReceive) == ESP_OK;
+}
+
+bool EspNowLink::transmit(const uint8_t* pData, uint8_t length) {
+    return esp_now_send(BROADCAST_ADDRESS, pData, length) == ESP_OK;
+}
+
+uint8_t EspNowLink::poll(uint8_t* pData) {
+    LinkFrame frame;
+
+    if (xQueueReceive(s_xFrames, &frame, 0) != pdPASS) {
+        return 0;
+    }
+
+    memcpy(pData, frame.data, frame.length);
+
+    return frame.length;
+}
+
+// runs in the WiFi task: just queue the frame, the game task will pick it up
+#if ESP_IDF_VERSION_MAJOR >= 5
+void EspNowLink::onReceive(const esp_now_recv_info_t* pInfo, const uint8_t* pData, int length) {
+#else
+void EspNowLink::onReceive(const uint8_t* pMac, const uint8_t* pData, int length) {
+#endif
+    if (length <= 0 || length > LINK_MAX_FRAME) {
+        return;
+    }
+
+    LinkFrame frame;
+    frame.due = 0;
+    frame.length = length;
+    memcpy(frame.data, pData, length);
+
+    xQueueSend(s_xFrames, &frame, 0); // if the queue is full the frame is lost
+}
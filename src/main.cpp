@@ -1,84 +1,312 @@
-/*
-TETRIS for ESP32 with SSD1306 OLED display
-
-MIT License
-
-Copyright (c) 2025 Lorenzo Monti
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-#include <Arduino.h>
-#include <SPI.h>
-#include <Wire.h>
-#include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
-
-#include "game.h"
-#include "joystick.h"
-
-#define SCREEN_WIDTH 128
-#define SCREEN_HEIGHT 64
-#define SCREEN_ADDRESS 0x3C
-
-#define I2C_SDA 7
-#define I2C_SCL 6
-
-#define OLED_RESET -1
-
-Joystick joystick;
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
-Game game(&joystick, &display);
-
-void setup() {
-  Serial.begin(115200);
-
-  // setup I2C pins
-  Wire.setPins(I2C_SDA, I2C_SCL);
-  Wire.begin();
-
-  // setup OLED display
-  if (!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS)) {
-    Serial.println(F("SSD1306 initialization failed!"));
-    for (;;);
-  }
-
-  display.setRotation(3);
-  display.setTextColor(SSD1306_WHITE);
-
-  // setup joystick
-  if (!joystick.begin()) {
-    Serial.println(F("Joystick initialization failed!"));
-    for (;;);
-  }
-
-  // initiaze game
-  if (!game.begin()) {
-    Serial.println(F("Game initialization failed!"));
-    for (;;);
-  }
-
-  Serial.println(F("Game initialized successfully!"));
-}
-
-void loop() {
-  // let's play Tetris!
-  game.waitCoins();
-  game.playMatch();
-  game.over();
-}
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+#include <LittleFS.h>
+
+#include "benchmark.h"
+#include "boot.h"
+#include "dataset.h"
+#include "game.h"
+#include "hint.h"
+#include "joystick.h"
+#include "link.h"
+#include "power.h"
+#include "renderer.h"
+#include "sequencer.h"
+#include "server.h"
+#include "spectator.h"
+#include "versus.h"
+
+#define SCREEN_WIDTH 128
+#define SCREEN_HEIGHT 64
+#define SCREEN_ADDRESS 0x3C
+
+#define I2C_SDA 7
+#define I2C_SCL 6
+
+#define OLED_RESET -1
+
+// RENDERER_PBM records every frame to this file on the flash filesystem
+#define PBM_FRAMES_PATH "/frames.pbm"
+
+// RECORD_DATASET records every placement to this file on the flash filesystem
+#define DATASET_PATH "/dataset.ttrd"
+
+// SPECTATOR streams the screen on the serial port, keyframes need room in the transmit buffer
+#define SPECTATOR_TX_BUFFER 2048 // bytes
+
+// BOT_SERVER serves many headless games on the serial port, pipelined requests wait in the receive buffer
+#define SERVER_BAUD 921600
+#define SERVER_RX_BUFFER 8192 // bytes
+#define SERVER_TX_BUFFER 8192 // bytes
+
+// VERSUS_LOOPBACK plays against a mirror of ourselves, to measure the protocol
+#define VERSUS_LOOPBACK_DELAY 50 // milliseconds
+#define VERSUS_LOOPBACK_LOSS 10 // percent
+
+BootProfiler boot;
+Joystick joystick;
+
+#if defined(RENDERER_TERMINAL)
+TerminalRenderer renderer(&Serial);
+#elif defined(RENDERER_PBM)
+File frames;
+PbmRenderer renderer(&frames);
+#elif defined(FAST_BOOT)
+// only the display boots fast, the other renderers boot as usual
+#define FAST_BOOT_DISPLAY
+FastSSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+SSD1306Renderer renderer(&display);
+#else
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+SSD1306Renderer renderer(&display);
+#endif
+
+Game game(&joystick, &renderer);
+Sequencer sequencer;
+
+#if defined(VERSUS_LOOPBACK)
+LoopbackLink link;
+Versus versus(&link, &game);
+#elif defined(VERSUS_MODE)
+EspNowLink link;
+Versus versus(&link, &game);
+#endif
+
+#if defined(GAME_BENCHMARK)
+Benchmark benchmark;
+#endif
+
+#if defined(BOT_SERVER)
+GameServer server(&Serial);
+#endif
+
+#if defined(SPECTATOR)
+Spectator spectator(&Serial);
+#endif
+
+#if defined(HINT_MODE)
+HintEngine hint(&joystick);
+#endif
+
+#if defined(IDLE_MODE)
+PowerManager power(&joystick, &sequencer);
+#endif
+
+#if defined(RECORD_DATASET)
+File dataset;
+DatasetWriter recorder(&dataset);
+#endif
+
+void setup() {
+  boot.mark(BOOT_STAGE_SETUP);
+
+#if defined(GAME_BENCHMARK)
+  // benchmark build: measure the game hot paths, report and stop
+  Serial.begin(115200);
+  delay(2000); // give the serial monitor time to connect
+  {
+    // a previous report uploaded to the flash filesystem, if any, is the baseline
+    String baseline;
+    File file;
+
+    if (LittleFS.begin(false) && (file = LittleFS.open(BENCHMARK_BASELINE_PATH, FILE_READ))) {
+      baseline = file.readString();
+      file.close();
+    }
+
+    if (!benchmark.run(&Serial, baseline.length() ? baseline.c_str() : NULL)) {
+      Serial.println(F("Benchmark failed!"));
+    }
+  }
+  for (;;) {
+    delay(1000);
+  }
+#endif
+
+#if defined(BOT_SERVER)
+  // bot server build: headless games driven over the serial port, nothing else runs
+  Serial.setRxBufferSize(SERVER_RX_BUFFER);
+  Serial.setTxBufferSize(SERVER_TX_BUFFER);
+  Serial.begin(SERVER_BAUD);
+
+  if (!server.begin()) {
+    Serial.println(F("Server initialization failed!"));
+    for (;;);
+  }
+
+  for (;;) {
+    server.poll();
+  }
+#endif
+
+#if defined(SPECTATOR)
+  Serial.setTxBufferSize(SPECTATOR_TX_BUFFER);
+#endif
+
+#if defined(FAST_BOOT_DISPLAY)
+  // setup I2C pins, the rest of the bus and the display come up in fastBoot()
+  Wire.setPins(I2C_SDA, I2C_SCL);
+
+#if defined(SPECTATOR)
+  renderer.setSpectator(&spectator);
+#endif
+
+  // the display and the first frame before the serial port and the joystick
+  if (!fastBoot(&boot, &Wire, &display, SCREEN_ADDRESS, &renderer, &joystick, &game)) {
+    for (;;);
+  }
+#else
+  Serial.begin(115200);
+  boot.mark(BOOT_STAGE_SERIAL);
+
+#if defined(RENDERER_PBM)
+  // setup frame recording, after the frames of the previous boots
+  if (!LittleFS.begin(true) || !(frames = LittleFS.open(PBM_FRAMES_PATH, FILE_APPEND))) {
+    Serial.println(F("Frame file initialization failed!"));
+    for (;;);
+  }
+#elif !defined(RENDERER_TERMINAL)
+  // setup I2C pins
+  Wire.setPins(I2C_SDA, I2C_SCL);
+  Wire.begin();
+  boot.mark(BOOT_STAGE_I2C);
+
+  // setup OLED display
+  if (!display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS)) {
+    Serial.println(F("SSD1306 initialization failed!"));
+    for (;;);
+  }
+
+  display.setRotation(3);
+  display.setTextColor(SSD1306_WHITE);
+  boot.mark(BOOT_STAGE_DISPLAY);
+
+#if defined(SPECTATOR)
+  renderer.setSpectator(&spectator);
+#endif
+#endif
+
+  // setup renderer
+  if (!renderer.begin()) {
+    Serial.println(F("Renderer initialization failed!"));
+    for (;;);
+  }
+
+  // setup joystick
+  if (!joystick.begin()) {
+    Serial.println(F("Joystick initialization failed!"));
+    for (;;);
+  }
+
+  boot.mark(BOOT_STAGE_TASKS);
+
+  // initiaze game
+  if (!game.begin()) {
+    Serial.println(F("Game initialization failed!"));
+    for (;;);
+  }
+#endif
+
+#if defined(PIECE_BAG)
+  game.setRandomizer(PieceGenerator::MODE_BAG);
+#endif
+
+  // setup music and sound effects
+  if (!sequencer.begin()) {
+    Serial.println(F("Sequencer initialization failed!"));
+    for (;;);
+  }
+
+  game.setSequencer(&sequencer);
+
+#if defined(IDLE_MODE)
+  // sleep on the attract and game over screens
+  game.setPower(&power);
+#endif
+
+#if defined(RECORD_DATASET)
+  // setup dataset recording, after the records of the previous boots
+  if (!LittleFS.begin(true) || !(dataset = LittleFS.open(DATASET_PATH, FILE_APPEND)) || !recorder.begin(dataset.size())) {
+    Serial.println(F("Dataset initialization failed!"));
+    for (;;);
+  }
+
+  game.setRecorder(&recorder);
+#endif
+
+#if defined(HINT_MODE)
+  // setup placement hints
+  if (!hint.begin()) {
+    Serial.println(F("Hint initialization failed!"));
+    for (;;);
+  }
+
+  game.setHint(&hint);
+#endif
+
+#if defined(VERSUS_LOOPBACK)
+  link.connect(&link);
+  link.setImpairment(VERSUS_LOOPBACK_DELAY, VERSUS_LOOPBACK_LOSS);
+#endif
+
+#if defined(VERSUS_LOOPBACK) || defined(VERSUS_MODE)
+  // setup versus mode
+  if (!versus.begin()) {
+    Serial.println(F("Versus initialization failed!"));
+    for (;;);
+  }
+
+  game.setVersus(&versus);
+#endif
+
+#if !defined(FAST_BOOT_DISPLAY)
+  game.showInsertCoins();
+  boot.mark(BOOT_STAGE_FIRST_FRAME);
+#endif
+
+  boot.mark(BOOT_STAGE_READY);
+
+  Serial.println(F("Game initialized successfully!"));
+  boot.report();
+
+#if defined(FAST_BOOT_DISPLAY)
+  if (!boot.inOrder()) {
+    Serial.println(F("Fast boot stages out of order!"));
+  }
+#endif
+}
+
+void loop() {
+  // let's play Tetris!
+  game.waitCoins();
+  game.playMatch();
+  game.over();
+}
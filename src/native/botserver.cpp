@@ -0,0 +1,284 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <thread>
+
+#include "server.h"
+
+// the bot server as a Linux daemon: every connection, on a Unix or a TCP socket, gets a GameServer
+// and games of its own, served by a thread of its own; the protocol is the one of the serial port
+//
+// usage: botserver unix:/run/tetris.sock
+//        botserver [host:]port
+// without a host, only connections from this machine are accepted: 0.0.0.0:port or [::]:port opens it up
+
+#define LISTEN_BACKLOG 64
+#define MAX_LISTENERS 4 // addresses of a host: the loopback is both 127.0.0.1 and ::1
+#define SOCKET_BUFFER 4096 // bytes received at once
+
+// a connected socket as the Stream of a GameServer
+// the received bytes are buffered, so parsing a request does not take a system call per byte
+class SocketStream : public Stream {
+public:
+    explicit SocketStream(int fd) : m_Fd(fd), m_Head(0), m_Tail(0) {}
+    virtual ~SocketStream() { close(m_Fd); }
+
+    int available() override {
+        if (m_Head == m_Tail) {
+            receive(MSG_DONTWAIT);
+        }
+
+        return m_Tail - m_Head;
+    }
+
+    int read() override { return (available() > 0) ? m_Buffer[m_Head++] : -1; }
+    int peek() override { return (available() > 0) ? m_Buffer[m_Head] : -1; }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    size_t write(const uint8_t* pBuffer, size_t size) override {
+        size_t count = 0;
+
+        while (count < size) {
+            ssize_t sent = send(m_Fd, pBuffer + count, size - count, MSG_NOSIGNAL);
+
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (sent <= 0) {
+                break; // the client is gone, the next wait tells
+            }
+
+            count += sent;
+        }
+
+        return count;
+    }
+
+    using Print::write;
+
+    // blocks until a request comes in, false once the client has closed the connection
+    bool wait() {
+        while (m_Head == m_Tail) {
+            int received = receive(0);
+
+            if (received == 0 || (received < 0 && errno != EINTR)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    int m_Fd;
+    uint8_t m_Buffer[SOCKET_BUFFER];
+    size_t m_Head;
+    size_t m_Tail;
+
+    int receive(int flags) {
+        ssize_t received = recv(m_Fd, m_Buffer, sizeof(m_Buffer), flags);
+
+        m_Head = 0;
+        m_Tail = (received > 0) ? received : 0;
+
+        return received;
+    }
+};
+
+static const char* s_pSocketPath = NULL; // removed when the daemon stops
+
+static void serve(int fd) {
+    SocketStream stream(fd);
+    GameServer server(&stream);
+
+    if (!server.begin()) {
+        fprintf(stderr, "Server initialization failed!\n");
+        return;
+    }
+
+    while (stream.wait()) {
+        server.poll(); // there is something to read, it never waits
+    }
+}
+
+static int listenUnix(const char* pPath) {
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (strlen(pPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "%s: path too long\n", pPath);
+        return -1;
+    }
+
+    strcpy(address.sun_path, pPath);
+    unlink(pPath); // left by a previous run
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0 || bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(fd, LISTEN_BACKLOG) < 0) {
+        perror(pPath);
+        return -1;
+    }
+
+    s_pSocketPath = pPath;
+
+    return fd;
+}
+
+// listens on every address of the host, returns how many
+static int listenTcp(const char* pAddress, int listeners[MAX_LISTENERS]) {
+    char host[256] = "";
+    const char* pPort = strrchr(pAddress, ':');
+
+    if (pPort != NULL) {
+        // an IPv6 address comes in brackets: [::1]:7000
+        if (pAddress[0] == '[' && pPort > pAddress && pPort[-1] == ']') {
+            snprintf(host, sizeof(host), "%.*s", (int)(pPort - pAddress) - 2, pAddress + 1);
+        } else {
+            snprintf(host, sizeof(host), "%.*s", (int)(pPort - pAddress), pAddress);
+        }
+
+        pPort++;
+    } else {
+        pPort = pAddress;
+    }
+
+    // no AI_PASSIVE: without a host, getaddrinfo() gives the loopback addresses, not the wildcard ones
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* pResults;
+    int error = getaddrinfo(host[0] ? host : NULL, pPort, &hints, &pResults);
+
+    if (error != 0) {
+        fprintf(stderr, "%s: %s\n", pAddress, gai_strerror(error));
+        return 0;
+    }
+
+    int count = 0;
+
+    for (struct addrinfo* pResult = pResults; pResult != NULL && count < MAX_LISTENERS; pResult = pResult->ai_next) {
+        int fd = socket(pResult->ai_family, pResult->ai_socktype, pResult->ai_protocol);
+
+        if (fd < 0) {
+            continue;
+        }
+
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        if (bind(fd, pResult->ai_addr, pResult->ai_addrlen) < 0 || listen(fd, LISTEN_BACKLOG) < 0) {
+            close(fd);
+            continue;
+        }
+
+        listeners[count++] = fd;
+    }
+
+    freeaddrinfo(pResults);
+
+    if (count == 0) {
+        perror(pAddress);
+    }
+
+    return count;
+}
+
+// every connection accepted on the listener is served by a thread of its own
+static void acceptConnections(int listener, bool tcp) {
+    for (;;) {
+        int fd = accept(listener, NULL, NULL);
+
+        if (fd < 0) {
+            if (errno != EINTR && errno != ECONNABORTED) {
+                perror("accept");
+            }
+
+            continue;
+        }
+
+        if (tcp) {
+            // a response goes out as soon as it is written, the client is waiting for it
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+
+        std::thread(serve, fd).detach();
+    }
+}
+
+static void stop(int number) {
+    if (s_pSocketPath != NULL) {
+        unlink(s_pSocketPath);
+    }
+
+    _exit(0);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s unix:PATH | [HOST:]PORT\n", argv[0]);
+        return 2;
+    }
+
+    bool tcp = strncmp(argv[1], "unix:", 5) != 0;
+    int listeners[MAX_LISTENERS];
+    int count = 0;
+
+    if (tcp) {
+        count = listenTcp(argv[1], listeners);
+    } else if ((listeners[0] = listenUnix(argv[1] + 5)) >= 0) {
+        count = 1;
+    }
+
+    if (count == 0) {
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    fprintf(stderr, "bot server listening on %s, %d games per connection\n", argv[1], SERVER_GAMES);
+
+    // a thread for each address but the first
+    for (int i = 1; i < count; i++) {
+        std::thread(acceptConnections, listeners[i], tcp).detach();
+    }
+
+    acceptConnections(listeners[0], tcp);
+}
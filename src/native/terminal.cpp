@@ -0,0 +1,158 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <Native.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+#include "game.h"
+#include "joystick.h"
+#include "renderer.h"
+
+// the game on a Linux terminal: drawn by the TerminalRenderer on standard output,
+// played with the keyboard, whose keys press the buttons of the shim
+//
+// keys: left / a, right / d, rotate: up / w / space, hold: h (left and right together), quit: q
+
+#define KEY_PRESS_TIME (3 * JOYSTICK_DEBOUNCE) // milliseconds, a terminal only tells when a key goes down
+
+static struct termios s_Saved;
+
+static void restoreTerminal() {
+    tcsetattr(STDIN_FILENO, TCSANOW, &s_Saved);
+    fputs("\x1b[?25h\r\n", stdout); // the cursor back
+}
+
+static bool rawTerminal() {
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &s_Saved) != 0) {
+        return false;
+    }
+
+    struct termios raw = s_Saved;
+    cfmakeraw(&raw);
+    raw.c_oflag |= OPOST; // the frames end their lines with \r\n anyway
+
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) {
+        return false;
+    }
+
+    fputs("\x1b[2J\x1b[?25l", stdout); // a clear screen, no cursor
+
+    return true;
+}
+
+static void press(uint8_t pin1, uint8_t pin2 = 0) {
+    Native::setPin(pin1, HIGH);
+
+    if (pin2) {
+        Native::setPin(pin2, HIGH);
+    }
+
+    delay(KEY_PRESS_TIME);
+    Native::setPin(pin1, LOW);
+
+    if (pin2) {
+        Native::setPin(pin2, LOW);
+    }
+}
+
+// the keyboard, in a thread of its own: the game task waits on the joystick as on the board
+static void readKeys() {
+    int escape = 0; // arrow keys come as ESC [ A..D
+
+    for (;;) {
+        char c;
+
+        if (read(STDIN_FILENO, &c, 1) != 1) {
+            c = 'q';
+        }
+
+        if (escape == 1) {
+            escape = (c == '[') ? 2 : 0;
+            continue;
+        }
+
+        if (escape == 2) {
+            escape = 0;
+            c = (c == 'A') ? 'w' : (c == 'C') ? 'd' : (c == 'D') ? 'a' : 0;
+        }
+
+        switch (c) {
+            case '\x1b':
+                escape = 1;
+                break;
+            case 'a':
+                press(PIN_BUTTON_LEFT);
+                break;
+            case 'd':
+                press(PIN_BUTTON_RIGHT);
+                break;
+            case 'w':
+            case ' ':
+                press(PIN_BUTTON_ROTATE);
+                break;
+            case 'h':
+                press(PIN_BUTTON_LEFT, PIN_BUTTON_RIGHT);
+                break;
+            case 'q':
+            case '\x03': // ctrl-c, raw mode gets no signal
+                restoreTerminal();
+                _exit(0); // the game task is blocked somewhere, no point in unwinding it
+            default:
+                break;
+        }
+    }
+}
+
+int main() {
+    if (!rawTerminal()) {
+        fprintf(stderr, "the game needs a terminal\n");
+        return 1;
+    }
+
+    setvbuf(stdout, NULL, _IONBF, 0); // the renderer does not flush, every frame goes out as drawn
+
+    static TerminalRenderer renderer(&Serial);
+    static Joystick joystick;
+    static Game game(&joystick, &renderer);
+
+    if (!renderer.begin() || !joystick.begin() || !game.begin()) {
+        restoreTerminal();
+        fprintf(stderr, "Game initialization failed!\n");
+        return 1;
+    }
+
+    std::thread(readKeys).detach();
+
+    game.showInsertCoins();
+
+    for (;;) {
+        game.waitCoins();
+        game.playMatch();
+        game.over();
+    }
+}
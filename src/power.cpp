@@ -0,0 +1,112 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <esp_sleep.h>
+
+#include "power.h"
+
+static const char* STATE_NAMES[PowerManager::STATE_COUNT] = {"attract", "playing", "game over"};
+static const uint32_t STATE_BUDGETS[PowerManager::STATE_COUNT] = {
+    WAKEUP_BUDGET_ATTRACT, WAKEUP_BUDGET_PLAYING, WAKEUP_BUDGET_GAME_OVER
+};
+
+PowerManager::PowerManager(Joystick* pJoystick, Sequencer* pSequencer)
+: m_pJoystick(pJoystick), m_pSequencer(pSequencer), m_State(STATE_COUNT),
+  m_StateStart(0), m_StateWakeups(0), m_Wakeups(0), m_SleepMillis(0) {
+    for (int i = 0; i < STATE_COUNT; i++) {
+        m_TotalMillis[i] = 0;
+        m_TotalWakeups[i] = 0;
+    }
+}
+
+PowerManager::~PowerManager() {
+}
+
+void PowerManager::enter(State state) {
+    uint32_t now = millis();
+    uint32_t count = wakeups();
+
+    if (m_State != STATE_COUNT) {
+        m_TotalMillis[m_State] += now - m_StateStart;
+        m_TotalWakeups[m_State] += count - m_StateWakeups;
+    }
+
+    m_State = state;
+    m_StateStart = now;
+    m_StateWakeups = count;
+}
+
+void PowerManager::idle() {
+    // light sleep stops the buzzer: let the sound end first
+    while (!m_pSequencer->silent()) {
+        delay(POWER_SILENCE_POLL);
+        m_Wakeups++;
+    }
+
+    Serial.flush(); // and the UART
+
+    uint32_t startTime = millis();
+
+    m_pJoystick->armWakeup();
+    esp_light_sleep_start();
+    m_pJoystick->disarmWakeup();
+
+    m_SleepMillis += millis() - startTime;
+    m_Wakeups++;
+}
+
+uint32_t PowerManager::wakeupsPerSecond() const {
+    uint32_t elapsedTime = millis() - m_StateStart;
+
+    if (m_State == STATE_COUNT || elapsedTime == 0) {
+        return 0;
+    }
+
+    return (wakeups() - m_StateWakeups) * 1000 / elapsedTime;
+}
+
+void PowerManager::report() {
+    uint32_t totalMillis = 0;
+
+    for (int i = 0; i < STATE_COUNT; i++) {
+        if (m_TotalMillis[i] == 0) {
+            continue;
+        }
+
+        // a short visit is measured as a full second, the budget is per second
+        uint32_t rate = m_TotalWakeups[i] * 1000 / ((m_TotalMillis[i] > 1000) ? m_TotalMillis[i] : 1000);
+
+        Serial.printf("Power: %s %u wakeups/s, budget %u%s\n",
+            STATE_NAMES[i], rate, STATE_BUDGETS[i], (rate > STATE_BUDGETS[i]) ? ", OVER BUDGET" : "");
+
+        totalMillis += m_TotalMillis[i];
+    }
+
+    Serial.printf("Power: asleep %u%% of the time\n", totalMillis ? (uint32_t)((uint64_t)m_SleepMillis * 100 / totalMillis) : 0);
+}
+
+uint32_t PowerManager::wakeups() const {
+    return m_pJoystick->wakeups() + m_pSequencer->wakeups() + m_Wakeups;
+}
@@ -0,0 +1,149 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "randomizer.h"
+
+#define GOLDEN_GAMMA 0x9E3779B97F4A7C15ULL
+
+RandomStream::RandomStream(uint64_t seed, uint32_t stream)
+: m_Seed(mix64(seed)), m_Gamma(mixGamma(seed + (stream + 1ULL) * GOLDEN_GAMMA)), m_Counter(0) {
+}
+
+uint32_t RandomStream::next() {
+    m_Counter++;
+
+    return mix64(m_Seed + m_Counter * m_Gamma) >> 32; // the high bits are the best mixed
+}
+
+// Lemire's multiply and reject: no division in the common case
+uint32_t RandomStream::below(uint32_t bound) {
+    uint64_t product = (uint64_t)next() * bound;
+    uint32_t low = (uint32_t)product;
+
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+
+        while (low < threshold) {
+            product = (uint64_t)next() * bound;
+            low = (uint32_t)product;
+        }
+    }
+
+    return product >> 32;
+}
+
+RandomStream RandomStream::split(uint32_t stream) const {
+    return RandomStream(mix64(m_Seed ^ m_Gamma), stream);
+}
+
+// SplitMix64 finalizer
+uint64_t RandomStream::mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+}
+
+// an odd increment with enough bit transitions, as in Java's SplittableRandom
+uint64_t RandomStream::mixGamma(uint64_t z) {
+    z = (z ^ (z >> 33)) * 0xFF51AFD7ED558CCDULL;
+    z = (z ^ (z >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+    z = (z ^ (z >> 33)) | 1;
+
+    return (__builtin_popcountll(z ^ (z >> 1)) < 24) ? z ^ 0xAAAAAAAAAAAAAAAAULL : z;
+}
+
+PieceGenerator::PieceGenerator(Mode mode)
+: m_Mode(mode), m_Seed(0), m_Stream(0) {
+    restart();
+}
+
+PieceGenerator::~PieceGenerator() {
+}
+
+void PieceGenerator::seed(uint64_t seed, uint32_t stream) {
+    m_Seed = seed;
+    m_Stream = stream;
+    m_Random = RandomStream(seed, stream);
+
+    restart();
+}
+
+void PieceGenerator::setMode(Mode mode) {
+    m_Mode = mode;
+    m_Random = RandomStream(m_Seed, m_Stream);
+
+    restart();
+}
+
+TetrominoType PieceGenerator::next() {
+    TetrominoType type = m_Preview[m_PreviewHead];
+
+    m_Preview[m_PreviewHead] = draw();
+    m_PreviewHead = (m_PreviewHead + 1) % PIECE_PREVIEW;
+
+    return type;
+}
+
+TetrominoType PieceGenerator::peek(uint8_t index) const {
+    assert(index < PIECE_PREVIEW);
+
+    return m_Preview[(m_PreviewHead + index) % PIECE_PREVIEW];
+}
+
+void PieceGenerator::restart() {
+    m_BagPosition = TETROMINO_COUNT; // empty
+
+    for (int i = 0; i < PIECE_PREVIEW; i++) {
+        m_Preview[i] = draw();
+    }
+
+    m_PreviewHead = 0;
+}
+
+TetrominoType PieceGenerator::draw() {
+    if (m_Mode == MODE_UNIFORM) {
+        return static_cast<TetrominoType>(m_Random.below(TETROMINO_COUNT));
+    }
+
+    if (m_BagPosition == TETROMINO_COUNT) {
+        // Fisher-Yates shuffle of a fresh bag
+        for (int i = 0; i < TETROMINO_COUNT; i++) {
+            m_Bag[i] = static_cast<TetrominoType>(i);
+        }
+
+        for (int i = TETROMINO_COUNT - 1; i > 0; i--) {
+            uint8_t j = m_Random.below(i + 1);
+            TetrominoType type = m_Bag[i];
+
+            m_Bag[i] = m_Bag[j];
+            m_Bag[j] = type;
+        }
+
+        m_BagPosition = 0;
+    }
+
+    return m_Bag[m_BagPosition++];
+}
@@ -0,0 +1,148 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "renderer.h"
+
+Renderer::Renderer()
+: m_Frames(0), m_PresentMicros(0) {
+}
+
+Renderer::~Renderer() {
+}
+
+void Renderer::present() {
+    uint32_t startTime = micros();
+
+    show();
+
+    m_PresentMicros += micros() - startTime;
+    m_Frames++;
+}
+
+void Renderer::report() {
+    Serial.printf("Renderer: %u frames, %uus per frame\n", m_Frames, m_Frames ? m_PresentMicros / m_Frames : 0);
+}
+
+SSD1306Renderer::SSD1306Renderer(Adafruit_SSD1306* pDisplay)
+: m_pDisplay(pDisplay), m_pSpectator(NULL) {
+}
+
+SSD1306Renderer::~SSD1306Renderer() {
+}
+
+void SSD1306Renderer::report() {
+    Renderer::report();
+
+    if (m_pSpectator) {
+        m_pSpectator->report();
+    }
+}
+
+void SSD1306Renderer::show() {
+    m_pDisplay->display();
+
+    if (m_pSpectator) {
+        m_pSpectator->frame(m_pDisplay->getBuffer());
+    }
+}
+
+CanvasRenderer::CanvasRenderer()
+: m_Canvas(PLAYSCREEN_WIDTH, PLAYSCREEN_HEIGHT) {
+}
+
+CanvasRenderer::~CanvasRenderer() {
+}
+
+bool CanvasRenderer::begin() {
+    if (m_Canvas.getBuffer() == NULL) {
+        return false; // out of memory
+    }
+
+    m_Canvas.setTextColor(1);
+
+    return true;
+}
+
+TerminalRenderer::TerminalRenderer(Print* pOut)
+: m_pOut(pOut) {
+}
+
+TerminalRenderer::~TerminalRenderer() {
+}
+
+void TerminalRenderer::show() {
+    // half blocks: upper, lower, full
+    static const char* const BLOCKS[4] = { " ", "\xE2\x96\x80", "\xE2\x96\x84", "\xE2\x96\x88" };
+
+    m_pOut->print("\x1b[H"); // cursor home
+
+    for (int y = 0; y < PLAYSCREEN_HEIGHT; y += 2) {
+        for (int x = 0; x < PLAYSCREEN_WIDTH; x++) {
+            int block = (m_Canvas.getPixel(x, y) ? 1 : 0) | (m_Canvas.getPixel(x, y + 1) ? 2 : 0);
+            m_pOut->print(BLOCKS[block]);
+        }
+
+        m_pOut->print("\r\n");
+    }
+
+    m_pOut->print("\x1b[J"); // erase whatever was printed below the previous frame
+}
+
+PbmRenderer::PbmRenderer(Print* pOut)
+: m_pOut(pOut), m_Unflushed(0) {
+}
+
+PbmRenderer::~PbmRenderer() {
+}
+
+void PbmRenderer::report() {
+    m_pOut->flush();
+    m_Unflushed = 0;
+
+    Renderer::report();
+}
+
+void PbmRenderer::show() {
+    // the canvas is already laid out as P4 rows: MSB first, each row padded to a byte
+    // but PBM uses 1 for black, so the pixels are inverted
+    const uint8_t* pBuffer = m_Canvas.getBuffer();
+    uint8_t row[PLAYSCREEN_WIDTH / 8];
+
+    m_pOut->printf("P4\n%d %d\n", PLAYSCREEN_WIDTH, PLAYSCREEN_HEIGHT);
+
+    for (int y = 0; y < PLAYSCREEN_HEIGHT; y++) {
+        for (int i = 0; i < PLAYSCREEN_WIDTH / 8; i++) {
+            row[i] = ~pBuffer[y * (PLAYSCREEN_WIDTH / 8) + i];
+        }
+
+        m_pOut->write(row, sizeof(row));
+    }
+
+    // every flush rewrites a flash page, not every frame needs to be safe at once
+    if (++m_Unflushed >= PBM_FLUSH_FRAMES) {
+        m_pOut->flush();
+        m_Unflushed = 0;
+    }
+}
@@ -0,0 +1,348 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "sequencer.h"
+
+#define LEDC_CHANNEL 0
+#define LEDC_RESOLUTION 8 // bits
+
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+#define LEDC_TONE_TARGET PIN_BUZZER // the 3.x API addresses pins rather than channels
+#else
+#define LEDC_TONE_TARGET LEDC_CHANNEL
+#endif
+
+// note durations, in sequencer ticks
+#define SIXTEENTH 15
+#define EIGHTH 30
+#define QUARTER 60
+#define DOTTED_QUARTER 90
+
+// Korobeiniki
+static const Note THEME[] = {
+    {76, QUARTER}, {71, EIGHTH}, {72, EIGHTH}, {74, QUARTER}, {72, EIGHTH}, {71, EIGHTH},
+    {69, QUARTER}, {69, EIGHTH}, {72, EIGHTH}, {76, QUARTER}, {74, EIGHTH}, {72, EIGHTH},
+    {71, DOTTED_QUARTER}, {72, EIGHTH}, {74, QUARTER}, {76, QUARTER},
+    {72, QUARTER}, {69, QUARTER}, {69, QUARTER}, {0, QUARTER},
+    {0, EIGHTH}, {74, QUARTER}, {77, EIGHTH}, {81, QUARTER}, {79, EIGHTH}, {77, EIGHTH},
+    {76, DOTTED_QUARTER}, {72, EIGHTH}, {76, QUARTER}, {74, EIGHTH}, {72, EIGHTH},
+    {71, QUARTER}, {71, EIGHTH}, {72, EIGHTH}, {74, QUARTER}, {76, QUARTER},
+    {72, QUARTER}, {69, QUARTER}, {69, QUARTER}, {0, QUARTER}
+};
+
+static const Note LANDING[] = {
+    {40, 6}
+};
+
+static const Note LINE_CLEAR[] = {
+    {72, SIXTEENTH / 2}, {76, SIXTEENTH / 2}, {79, SIXTEENTH / 2}, {84, SIXTEENTH}
+};
+
+static const Note GAME_OVER[] = {
+    {72, EIGHTH}, {67, EIGHTH}, {64, EIGHTH}, {60, QUARTER * 2}
+};
+
+#define TRACK(notes, loop) { notes, sizeof(notes) / sizeof(notes[0]), loop }
+
+static const Track TRACK_THEME = TRACK(THEME, true);
+static const Track TRACK_LANDING = TRACK(LANDING, false);
+static const Track TRACK_LINE_CLEAR = TRACK(LINE_CLEAR, false);
+static const Track TRACK_GAME_OVER = TRACK(GAME_OVER, false);
+
+// MIDI notes 120 to 131, every other octave is obtained by halving
+static const uint16_t TOP_OCTAVE[12] = {
+    8372, 8870, 9397, 9956, 10548, 11175, 11840, 12544, 13290, 14080, 14917, 15804
+};
+
+Sequencer::Sequencer()
+: m_QueueHead(0), m_QueueTail(0), m_Frequency(0), m_Timer(NULL),
+  m_LastTick(0), m_Pending(0), m_bSilent(true), m_Wakeups(0), m_TickMicros(0), m_MaxTickMicros(0), m_Dropped(0) {
+    m_Music.pTrack = NULL;
+    m_Effect.pTrack = NULL;
+}
+
+Sequencer::~Sequencer() {
+    if (m_Timer != NULL) {
+        esp_timer_stop(m_Timer);
+        esp_timer_delete(m_Timer);
+    }
+}
+
+bool Sequencer::begin() {
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (!ledcAttachChannel(PIN_BUZZER, 1000, LEDC_RESOLUTION, LEDC_CHANNEL)) {
+        return false;
+    }
+#else
+    ledcSetup(LEDC_CHANNEL, 1000, LEDC_RESOLUTION);
+    ledcAttachPin(PIN_BUZZER, LEDC_CHANNEL);
+#endif
+    ledcWriteTone(LEDC_TONE_TARGET, 0);
+
+    esp_timer_create_args_t args = {};
+    args.callback = timerCallback;
+    args.arg = this;
+    args.name = "sequencer";
+
+    if (esp_timer_create(&args, &m_Timer) != ESP_OK) {
+        return false;
+    }
+
+    return true; // the first command starts the timer
+}
+
+bool Sequencer::post(Command command) {
+    uint8_t head = m_QueueHead.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) & (SEQUENCER_QUEUE_LENGTH - 1);
+
+    if (next == m_QueueTail.load(std::memory_order_acquire)) {
+        m_Dropped++;
+        return false;
+    }
+
+    m_Queue[head] = command;
+    m_QueueHead.store(next, std::memory_order_release);
+
+    if (m_Timer != NULL) {
+        m_bSilent.store(false, std::memory_order_release);
+        kick();
+    }
+
+    return true;
+}
+
+bool Sequencer::render(uint8_t* pSamples, size_t count, uint32_t sampleRate) {
+    if (m_Timer != NULL) {
+        return false;
+    }
+
+    uint32_t ticks = 0;
+    uint64_t nextTick = 0; // sample at which the next tick starts
+    uint32_t phase = 0;
+    uint16_t frequency = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (i == nextTick) {
+            frequency = advance();
+            ticks++;
+            // rounded from the start rather than accumulated, so a fractional tick length does not drift
+            nextTick = ((uint64_t)ticks * sampleRate * SEQUENCER_TICK + 500) / 1000;
+        }
+
+        if (frequency == 0) {
+            pSamples[i] = 128; // silence
+            continue;
+        }
+
+        phase += frequency;
+        if (phase >= sampleRate) {
+            phase -= sampleRate;
+        }
+
+        pSamples[i] = (phase < sampleRate / 2) ? 192 : 64;
+    }
+
+    return true;
+}
+
+void Sequencer::report() {
+    Serial.printf("Sequencer: %u wakeups, %uus average, %uus max, %u commands dropped\n",
+        m_Wakeups, m_Wakeups ? m_TickMicros / m_Wakeups : 0, m_MaxTickMicros, m_Dropped);
+}
+
+// consume the pending commands and move both voices forward by one tick
+// returns the frequency to be played
+uint16_t Sequencer::advance() {
+    uint8_t tail = m_QueueTail.load(std::memory_order_relaxed);
+
+    while (tail != m_QueueHead.load(std::memory_order_acquire)) {
+        execute(static_cast<Command>(m_Queue[tail]));
+        tail = (tail + 1) & (SEQUENCER_QUEUE_LENGTH - 1);
+        m_QueueTail.store(tail, std::memory_order_release);
+    }
+
+    uint8_t music = step(&m_Music);
+    uint8_t effect = step(&m_Effect);
+
+    // a single buzzer: effects take over the music while they play
+    return frequency((m_Effect.pTrack != NULL) ? effect : music);
+}
+
+// returns the number of ticks before the pitch of a voice may change, 0 if both voices are silent
+uint8_t Sequencer::nextChange() const {
+    const Voice* voices[] = {&m_Music, &m_Effect};
+    uint8_t next = 0;
+
+    for (size_t i = 0; i < sizeof(voices) / sizeof(voices[0]); i++) {
+        if (voices[i]->pTrack == NULL) {
+            continue;
+        }
+
+        // a note ends with a silent tick, after which the next note is loaded
+        uint8_t ticks = (voices[i]->ticksLeft > 0) ? voices[i]->ticksLeft : 1;
+
+        if (next == 0 || ticks < next) {
+            next = ticks;
+        }
+    }
+
+    return next;
+}
+
+void Sequencer::execute(Command command) {
+    switch (command) {
+        case COMMAND_PLAY_MUSIC:
+            start(&m_Music, &TRACK_THEME);
+            break;
+        case COMMAND_STOP_MUSIC:
+            m_Music.pTrack = NULL;
+            break;
+        case COMMAND_EFFECT_LANDING:
+            start(&m_Effect, &TRACK_LANDING);
+            break;
+        case COMMAND_EFFECT_LINE_CLEAR:
+            start(&m_Effect, &TRACK_LINE_CLEAR);
+            break;
+        case COMMAND_EFFECT_GAME_OVER:
+            start(&m_Effect, &TRACK_GAME_OVER);
+            break;
+        default:
+            break;
+    }
+}
+
+void Sequencer::start(Voice* pVoice, const Track* pTrack) {
+    pVoice->pTrack = pTrack;
+    pVoice->position = 0;
+    pVoice->ticksLeft = 0;
+}
+
+// returns the pitch of the voice for the current tick, 0 if silent
+uint8_t Sequencer::step(Voice* pVoice) {
+    const Track* pTrack = pVoice->pTrack;
+
+    if (pTrack == NULL) {
+        return 0;
+    }
+
+    if (pVoice->ticksLeft == 0) {
+        if (pVoice->position >= pTrack->length) {
+            if (!pTrack->loop) {
+                pVoice->pTrack = NULL;
+                return 0;
+            }
+
+            pVoice->position = 0;
+        }
+
+        pVoice->ticksLeft = pTrack->pNotes[pVoice->position].duration;
+        pVoice->position++;
+    }
+
+    assert(pVoice->ticksLeft > 0);
+
+    uint8_t pitch = pTrack->pNotes[pVoice->position - 1].pitch;
+    pVoice->ticksLeft--;
+
+    // the last tick of every note is silent, so repeated notes can be told apart
+    return (pVoice->ticksLeft == 0) ? 0 : pitch;
+}
+
+// the timer may be armed for the end of a long note: bring the next step forward
+// safe against a concurrent tick(), which re-checks the queue after re-arming the timer
+void Sequencer::kick() {
+    esp_timer_stop(m_Timer); // fails harmlessly if the timer is not armed
+    esp_timer_start_once(m_Timer, 0); // fails harmlessly if tick() has re-armed it meanwhile
+}
+
+void Sequencer::tick() {
+    uint32_t startTime = micros();
+
+    // catch up on the ticks elapsed since the last wakeup, then take the new commands
+    // an early wakeup, for a command, counts as a full tick so the command is never delayed
+    int64_t now = esp_timer_get_time();
+
+    if (m_Pending == 0) {
+        m_LastTick = now - SEQUENCER_TICK * 1000; // after a silence, the tick grid restarts now
+        m_Pending = 1;
+    }
+
+    int64_t elapsed = (now - m_LastTick) / (SEQUENCER_TICK * 1000);
+    uint8_t ticks = (elapsed < 1) ? 1 : (elapsed > m_Pending) ? m_Pending : elapsed;
+
+    for (uint8_t i = 1; i < ticks; i++) {
+        step(&m_Music);
+        step(&m_Effect);
+    }
+
+    uint16_t frequency = advance();
+
+    // stay on the tick grid, so the tempo does not drift with the timer latency
+    m_LastTick += ticks * SEQUENCER_TICK * 1000;
+
+    if (frequency != m_Frequency) {
+        ledcWriteTone(LEDC_TONE_TARGET, frequency);
+        m_Frequency = frequency;
+    }
+
+    uint8_t next = nextChange();
+
+    if (next > 0) {
+        m_Pending = next;
+        m_bSilent.store(false, std::memory_order_release);
+        int64_t timeout = m_LastTick + next * SEQUENCER_TICK * 1000 - now;
+        esp_timer_start_once(m_Timer, (timeout > 0) ? timeout : 0);
+    } else {
+        m_Pending = 0;
+        m_bSilent.store(true, std::memory_order_release);
+    }
+
+    // a command posted while we were busy must not wait for the end of the note
+    if (m_QueueTail.load(std::memory_order_relaxed) != m_QueueHead.load(std::memory_order_acquire)) {
+        m_bSilent.store(false, std::memory_order_release);
+        kick();
+    }
+
+    uint32_t elapsedTime = micros() - startTime;
+
+    m_Wakeups++;
+    m_TickMicros += elapsedTime;
+    if (elapsedTime > m_MaxTickMicros) {
+        m_MaxTickMicros = elapsedTime;
+    }
+}
+
+uint16_t Sequencer::frequency(uint8_t pitch) {
+    if (pitch == 0 || pitch > 131) {
+        return 0;
+    }
+
+    return TOP_OCTAVE[pitch % 12] >> (10 - pitch / 12);
+}
+
+// runs in the esp_timer task, not in the game task
+void Sequencer::timerCallback(void* pArg) {
+    static_cast<Sequencer*>(pArg)->tick();
+}
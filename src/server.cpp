@@ -0,0 +1,267 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <new>
+
+#include "server.h"
+#include "tetromino.h"
+
+#define RESPONSE_FLAG 0x80
+
+GameServer::GameServer(Stream* pIo)
+: m_pIo(pIo), m_Received(0) {
+    for (int i = 0; i < SERVER_GAMES; i++) {
+        m_Games[i] = NULL;
+        m_ToppedOut[i] = false;
+    }
+}
+
+GameServer::~GameServer() {
+    for (int i = 0; i < SERVER_GAMES; i++) {
+        delete m_Games[i];
+    }
+}
+
+bool GameServer::begin() {
+    if (!m_Renderer.begin()) {
+        return false;
+    }
+
+    for (int i = 0; i < SERVER_GAMES; i++) {
+        m_Games[i] = new (std::nothrow) Game(&m_Joystick, &m_Renderer);
+
+        if (m_Games[i] == NULL) {
+            return false;
+        }
+
+        m_Games[i]->clear();
+        m_Games[i]->seed(0, i);
+        m_Games[i]->newTetromino();
+    }
+
+    return true;
+}
+
+void GameServer::poll() {
+    int available = m_pIo->available();
+
+    if (available <= 0) {
+        delay(1);
+        return;
+    }
+
+    size_t room = sizeof(m_Request) - m_Received;
+    m_Received += m_pIo->readBytes(&m_Request[m_Received], ((size_t)available < room) ? available : room);
+
+    size_t start = 0;
+
+    for (;;) {
+        // look for the start of a request
+        while (start < m_Received && m_Request[start] != SERVER_SYNC) {
+            start++;
+        }
+
+        if (m_Received - start < SERVER_HEADER_SIZE) {
+            break;
+        }
+
+        const uint8_t* pRequest = &m_Request[start];
+        uint16_t count = pRequest[4] | (pRequest[5] << 8);
+        size_t entry = entrySize(pRequest[1]);
+
+        if (entry == 0 || count > SERVER_MAX_BATCH) {
+            start++; // not a request
+            continue;
+        }
+
+        size_t length = SERVER_HEADER_SIZE + count * entry + 1;
+
+        if (m_Received - start < length) {
+            break; // wait for the rest
+        }
+
+        if (crc8(&pRequest[1], length - 2) != pRequest[length - 1]) {
+            start++;
+            continue;
+        }
+
+        handle(pRequest);
+        start += length;
+    }
+
+    // keep the beginning of the next request
+    memmove(m_Request, &m_Request[start], m_Received - start);
+    m_Received -= start;
+}
+
+void GameServer::handle(const uint8_t* pRequest) {
+    uint8_t type = pRequest[1];
+    uint16_t count = pRequest[4] | (pRequest[5] << 8);
+    const uint8_t* pEntry = &pRequest[SERVER_HEADER_SIZE];
+    uint8_t* pState = &m_Response[SERVER_HEADER_SIZE];
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t game = pEntry[0] | (pEntry[1] << 8);
+        uint8_t status = (game < SERVER_GAMES) ? STATUS_OK : STATUS_INVALID_GAME;
+        uint8_t lines = 0;
+
+        if (status == STATUS_OK) {
+            switch (type) {
+                case REQUEST_RESET: {
+                    uint64_t seed = 0;
+
+                    for (int b = 7; b >= 0; b--) {
+                        seed = (seed << 8) | pEntry[2 + b];
+                    }
+
+                    m_Games[game]->clear();
+                    m_Games[game]->seed(seed, game);
+                    m_ToppedOut[game] = !m_Games[game]->newTetromino();
+                    status = m_ToppedOut[game] ? STATUS_TOPPED_OUT : STATUS_OK;
+                    break;
+                }
+                case REQUEST_STEP:
+                    status = step(game, pEntry[2], static_cast<int8_t>(pEntry[3]), &lines);
+                    break;
+                default:
+                    status = m_ToppedOut[game] ? STATUS_TOPPED_OUT : STATUS_OK;
+                    break;
+            }
+        }
+
+        encodeState(game, status, lines, pState);
+
+        pEntry += entrySize(type);
+        pState += SERVER_STATE_SIZE;
+    }
+
+    size_t length = pState - m_Response;
+
+    m_Response[0] = SERVER_SYNC;
+    m_Response[1] = type | RESPONSE_FLAG;
+    m_Response[2] = pRequest[2];
+    m_Response[3] = pRequest[3];
+    m_Response[4] = count & 0xFF;
+    m_Response[5] = count >> 8;
+    m_Response[length] = crc8(&m_Response[1], length - 1);
+    length++;
+
+    // a bot waits for its answer: unlike the spectator stream, this blocks until it is all queued
+    m_pIo->write(m_Response, length);
+}
+
+// drops the falling tetromino from column x with the given rotation
+uint8_t GameServer::step(uint16_t game, uint8_t rotation, int8_t x, uint8_t* pLines) {
+    Game* pGame = m_Games[game];
+
+    if (m_ToppedOut[game]) {
+        return STATUS_TOPPED_OUT;
+    }
+
+    // the blocks are at most 2 columns away from x, anything further is off the board anyway
+    if (rotation >= ROTATION_COUNT || x < -2 || x > BOARD_WIDTH + 1) {
+        return STATUS_INVALID_PLACEMENT;
+    }
+
+    const Tetromino* pTetromino = &(Pieces[pGame->m_TetrominoType][rotation]);
+
+    if (pGame->tetrominoOverlaps(pTetromino, x - pGame->m_TetrominoX)) {
+        return STATUS_INVALID_PLACEMENT;
+    }
+
+    pGame->m_TetrominoX = x;
+    pGame->m_TetrominoRotation = static_cast<TetrominoRotation>(rotation);
+    pGame->m_pTetromino = pTetromino;
+
+    while (pGame->moveTetromino(0, -1)) {
+    }
+
+    pGame->placeTetromino();
+
+    // no animation, the rows go away at once
+    if (pGame->clearCompletedRows()) {
+        for (int i = 0; i < BOARD_HEIGHT; i++) {
+            if (pGame->m_Completed[i]) {
+                (*pLines)++;
+            }
+        }
+
+        pGame->compactBoard();
+    }
+
+    m_ToppedOut[game] = !pGame->newTetromino();
+
+    return m_ToppedOut[game] ? STATUS_TOPPED_OUT : STATUS_OK;
+}
+
+void GameServer::encodeState(uint16_t game, uint8_t status, uint8_t lines, uint8_t* pOut) {
+    pOut[0] = game & 0xFF;
+    pOut[1] = game >> 8;
+    pOut[2] = status;
+    pOut[3] = lines;
+
+    if (status == STATUS_INVALID_GAME) {
+        memset(&pOut[4], 0, SERVER_STATE_SIZE - 4);
+        return;
+    }
+
+    const Game* pGame = m_Games[game];
+
+    pOut[4] = pGame->m_TetrominoType;
+
+    for (int i = 0; i < PIECE_PREVIEW; i++) {
+        pOut[5 + i] = pGame->nextPiece(i);
+    }
+
+    pGame->packBoard(&pOut[5 + PIECE_PREVIEW]); // straight into the response
+}
+
+// bytes per entry of a request type, 0 if the type is unknown
+size_t GameServer::entrySize(uint8_t type) {
+    switch (type) {
+        case REQUEST_RESET:
+            return SERVER_RESET_SIZE;
+        case REQUEST_STEP:
+            return SERVER_STEP_SIZE;
+        case REQUEST_OBSERVE:
+            return SERVER_OBSERVE_SIZE;
+        default:
+            return 0;
+    }
+}
+
+uint8_t GameServer::crc8(const uint8_t* pData, size_t length) {
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= pData[i];
+
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+
+    return crc;
+}
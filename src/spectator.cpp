@@ -0,0 +1,157 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "spectator.h"
+
+#define MAX_RUN 128
+
+Spectator::Spectator(Print* pOut)
+: m_pOut(pOut), m_FrameNumber(0), m_SinceKeyframe(0), m_bKeyframePending(true),
+  m_Frames(0), m_Keyframes(0), m_Skipped(0), m_Bytes(0) {
+    memset(m_Previous, 0, sizeof(m_Previous));
+}
+
+Spectator::~Spectator() {
+}
+
+void Spectator::frame(const uint8_t* pFramebuffer) {
+    static const uint8_t ZEROS[SPECTATOR_PAGE_SIZE] = {};
+
+    bool keyframe = m_bKeyframePending || m_SinceKeyframe >= SPECTATOR_KEYFRAME_INTERVAL;
+    uint8_t mask = 0;
+    size_t length = SPECTATOR_HEADER_SIZE;
+
+    for (int page = 0; page < SPECTATOR_PAGES; page++) {
+        const uint8_t* pPage = &pFramebuffer[page * SPECTATOR_PAGE_SIZE];
+        const uint8_t* pPrevious = &m_Previous[page * SPECTATOR_PAGE_SIZE];
+
+        if (!keyframe && memcmp(pPage, pPrevious, SPECTATOR_PAGE_SIZE) == 0) {
+            continue;
+        }
+
+        mask |= 1 << page;
+        length += encodePage(pPage, keyframe ? ZEROS : pPrevious, &m_Packet[length]);
+    }
+
+    if (mask == 0) {
+        return; // nothing changed
+    }
+
+    uint16_t payload = length - SPECTATOR_HEADER_SIZE;
+
+    m_Packet[0] = SPECTATOR_SYNC;
+    m_Packet[1] = keyframe ? PACKET_KEYFRAME : PACKET_DELTA;
+    m_Packet[2] = m_FrameNumber;
+    m_Packet[3] = mask;
+    m_Packet[4] = payload & 0xFF;
+    m_Packet[5] = payload >> 8;
+    m_Packet[length] = crc8(&m_Packet[1], length - 1);
+    length++;
+
+    // don't stall the game on a slow link: skip the frame, the next delta will include its changes
+    if ((size_t)m_pOut->availableForWrite() < length) {
+        m_bKeyframePending = m_bKeyframePending || keyframe;
+        m_Skipped++;
+        return;
+    }
+
+    m_pOut->write(m_Packet, length);
+    memcpy(m_Previous, pFramebuffer, SPECTATOR_FRAMEBUFFER_SIZE);
+
+    m_FrameNumber++;
+    m_Frames++;
+    m_Bytes += length;
+
+    if (keyframe) {
+        m_Keyframes++;
+        m_SinceKeyframe = 0;
+        m_bKeyframePending = false;
+    } else {
+        m_SinceKeyframe++;
+    }
+}
+
+void Spectator::report() {
+    Serial.printf("Spectator: %u frames (%u keyframes), %u skipped, %u bytes per frame\n",
+        m_Frames, m_Keyframes, m_Skipped, m_Frames ? m_Bytes / m_Frames : 0);
+}
+
+size_t Spectator::encodePage(const uint8_t* pPage, const uint8_t* pReference, uint8_t* pOut) {
+    uint8_t delta[SPECTATOR_PAGE_SIZE];
+    size_t length = 0;
+    int i = 0;
+
+    for (int k = 0; k < SPECTATOR_PAGE_SIZE; k++) {
+        delta[k] = pPage[k] ^ pReference[k];
+    }
+
+    while (i < SPECTATOR_PAGE_SIZE) {
+        int run = 1;
+
+        while (i + run < SPECTATOR_PAGE_SIZE && run < MAX_RUN && delta[i + run] == delta[i]) {
+            run++;
+        }
+
+        if (run >= 3) {
+            pOut[length++] = 0x80 | (run - 1);
+            pOut[length++] = delta[i];
+            i += run;
+            continue;
+        }
+
+        // literals, up to the next run of 3 equal bytes
+        int start = i;
+        int count = 0;
+
+        while (i < SPECTATOR_PAGE_SIZE && count < MAX_RUN) {
+            if (i + 2 < SPECTATOR_PAGE_SIZE && delta[i] == delta[i + 1] && delta[i] == delta[i + 2]) {
+                break;
+            }
+
+            i++;
+            count++;
+        }
+
+        pOut[length++] = count - 1;
+        memcpy(&pOut[length], &delta[start], count);
+        length += count;
+    }
+
+    return length;
+}
+
+uint8_t Spectator::crc8(const uint8_t* pData, size_t length) {
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= pData[i];
+
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+
+    return crc;
+}
@@ -0,0 +1,469 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "versus.h"
+#include "tetromino.h"
+
+#define FULL_ROW ((1 << BOARD_WIDTH) - 1)
+
+Versus::Versus(Link* pLink, Game* pGame)
+: m_pLink(pLink), m_pGame(pGame), m_MatchId(0) {
+}
+
+Versus::~Versus() {
+}
+
+bool Versus::begin() {
+    if (!m_pLink->begin()) {
+        return false;
+    }
+
+    reset();
+
+    return true;
+}
+
+void Versus::reset() {
+    uint8_t buffer[LINK_MAX_FRAME];
+
+    // whatever is still in flight belongs to the previous match
+    while (m_pLink->receive(buffer) > 0) {
+    }
+
+    // a new match id, so the opponent knows this is another match
+    uint8_t previous = m_MatchId;
+
+    do {
+        m_MatchId = esp_random() & 0xFF;
+    } while (m_MatchId == 0 || m_MatchId == previous);
+
+    m_LocalSeq = 0;
+    m_GarbageSent = 0;
+    m_bToppedOut = false;
+    m_LastHeartbeat = millis();
+    m_LastSnapshot = m_LastHeartbeat;
+
+    m_RemoteMatchId = 0;
+    resetRemote();
+
+    m_StartTime = millis();
+    m_ResyncCount = 0;
+    m_LastResyncLatency = 0;
+    m_MaxResyncLatency = 0;
+}
+
+void Versus::resetRemote() {
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        m_Mirror[i] = 0;
+    }
+
+    for (int i = 0; i < VERSUS_HISTORY_LENGTH; i++) {
+        m_History[i].valid = false;
+    }
+
+    m_RemoteSeq = 0;
+    m_GarbageReceived = 0;
+    m_PendingGarbage = 0;
+    m_bOpponentToppedOut = false;
+
+    m_bResyncPending = false;
+    m_ResyncRequestTime = 0;
+    m_ResyncSentTime = 0;
+}
+
+void Versus::poll() {
+    uint8_t buffer[LINK_MAX_FRAME];
+    uint8_t length;
+
+    while ((length = m_pLink->receive(buffer)) > 0) {
+        handle(buffer, length);
+    }
+
+    uint32_t now = millis();
+
+    if (now - m_LastHeartbeat >= VERSUS_HEARTBEAT_PERIOD) {
+        sendHeartbeat();
+    }
+
+    if (now - m_LastSnapshot >= VERSUS_SNAPSHOT_PERIOD) {
+        sendSnapshot();
+    }
+
+    // the request or the snapshot may have been lost, ask again
+    if (m_bResyncPending && now - m_ResyncSentTime >= VERSUS_RESYNC_RETRY) {
+        uint8_t message[VERSUS_RESYNC_SIZE];
+        writeHeader(message, VERSUS_MSG_RESYNC);
+        m_pLink->send(message, VERSUS_RESYNC_SIZE);
+        m_ResyncSentTime = now;
+    }
+}
+
+void Versus::pieceLocked(TetrominoType type, TetrominoRotation rotation, int8_t x, int8_t y, uint8_t garbage, uint8_t hole) {
+    assert(x >= 0 && x < 16);
+    assert(y >= 0 && y < BOARD_HEIGHT);
+
+    uint32_t bits = type | (rotation << 3) | (x << 5) | (y << 9) | (garbage << 14) | (hole << 18);
+    uint8_t message[VERSUS_LOCK_SIZE];
+
+    m_LocalSeq++;
+
+    writeHeader(message, VERSUS_MSG_LOCK);
+    message[3] = m_LocalSeq;
+    message[4] = bits & 0xFF;
+    message[5] = (bits >> 8) & 0xFF;
+    message[6] = (bits >> 16) & 0xFF;
+
+    m_pLink->send(message, VERSUS_LOCK_SIZE);
+}
+
+void Versus::linesCleared(uint8_t lines) {
+    // classic rules: a tetris sends four lines, anything less sends one line fewer than it cleared
+    uint8_t garbage = (lines >= 4) ? 4 : lines - 1;
+
+    if (lines == 0 || garbage == 0) {
+        return;
+    }
+
+    m_GarbageSent += garbage;
+    sendGarbage();
+}
+
+void Versus::toppedOut() {
+    m_bToppedOut = true;
+
+    for (int i = 0; i < VERSUS_TOPPED_OUT_REPEAT; i++) {
+        sendHeartbeat();
+    }
+}
+
+uint8_t Versus::takeGarbage() {
+    uint8_t lines = (m_PendingGarbage > VERSUS_MAX_GARBAGE) ? VERSUS_MAX_GARBAGE : m_PendingGarbage;
+
+    m_PendingGarbage -= lines;
+
+    return lines;
+}
+
+void Versus::report() {
+    uint32_t elapsed = millis() - m_StartTime;
+
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+
+    Serial.printf("Versus: sent %u B (%u B/s), received %u B (%u B/s), %u frames dropped\n",
+        m_pLink->bytesSent(), m_pLink->bytesSent() * 1000 / elapsed,
+        m_pLink->bytesReceived(), m_pLink->bytesReceived() * 1000 / elapsed,
+        m_pLink->framesDropped());
+    Serial.printf("Versus: %u resyncs, last latency %ums, max latency %ums\n",
+        m_ResyncCount, m_LastResyncLatency, m_MaxResyncLatency);
+}
+
+void Versus::handle(const uint8_t* pData, uint8_t length) {
+    if (length < VERSUS_HEADER_SIZE || pData[1] == 0) {
+        return;
+    }
+
+    VersusMessageType type = static_cast<VersusMessageType>(pData[0] & 0x0F);
+    const uint8_t* pBody = &pData[VERSUS_HEADER_SIZE];
+
+    if (pData[1] != m_RemoteMatchId) {
+        // the opponent started another match: its board, and the garbage sent to it, start over
+        resetRemote();
+        m_RemoteMatchId = pData[1];
+        m_GarbageSent = 0;
+    }
+
+    // about the match against us, or about another one
+    bool current = (pData[2] == m_MatchId);
+
+    if (current && (pData[0] & VERSUS_FLAG_TOPPED_OUT)) {
+        m_bOpponentToppedOut = true;
+    }
+
+    switch (type) {
+        case VERSUS_MSG_LOCK:
+            if (length == VERSUS_LOCK_SIZE) {
+                VersusLock lock;
+                lock.valid = true;
+                lock.seq = pBody[0];
+                lock.bits = pBody[1] | (pBody[2] << 8) | ((uint32_t)pBody[3] << 16);
+                handleLock(&lock);
+            }
+            break;
+
+        case VERSUS_MSG_GARBAGE:
+            if (length == VERSUS_GARBAGE_SIZE && current) {
+                handleGarbage(pBody[0] | (pBody[1] << 8));
+            }
+            break;
+
+        case VERSUS_MSG_HEARTBEAT:
+            if (length == VERSUS_HEARTBEAT_SIZE) {
+                if (current) {
+                    handleGarbage(pBody[3] | (pBody[4] << 8));
+                }
+
+                handleHeartbeat(pBody[0], pBody[1] | (pBody[2] << 8));
+            }
+            break;
+
+        case VERSUS_MSG_RESYNC:
+            sendSnapshot();
+            break;
+
+        case VERSUS_MSG_SNAPSHOT:
+            if (length == VERSUS_SNAPSHOT_SIZE) {
+                handleSnapshot(pBody[0], &pBody[1]);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void Versus::handleLock(const VersusLock* pLock) {
+    int8_t ahead = (int8_t)(pLock->seq - m_RemoteSeq);
+
+    if (ahead <= 0) {
+        return; // duplicate or stale
+    }
+
+    // keep it around, a snapshot older than this lock may arrive later
+    m_History[pLock->seq % VERSUS_HISTORY_LENGTH] = *pLock;
+
+    if (ahead == 1 && !m_bResyncPending) {
+        applyLock(pLock->bits);
+        m_RemoteSeq = pLock->seq;
+    } else {
+        requestResync(); // at least one lock went missing
+    }
+}
+
+void Versus::handleGarbage(uint16_t total) {
+    // the running total makes lost garbage messages harmless
+    int16_t delta = (int16_t)(total - m_GarbageReceived);
+
+    if (delta > 0) {
+        m_PendingGarbage += delta;
+        m_GarbageReceived = total;
+    }
+}
+
+void Versus::handleHeartbeat(uint8_t seq, uint16_t remoteChecksum) {
+    if (m_bResyncPending) {
+        return;
+    }
+
+    if (seq == m_RemoteSeq) {
+        uint8_t board[PACKED_BOARD_SIZE];
+        packMirror(board);
+
+        if (checksum(board, PACKED_BOARD_SIZE) != remoteChecksum) {
+            requestResync(); // the mirror diverged
+        }
+    } else if ((int8_t)(seq - m_RemoteSeq) > 0) {
+        requestResync(); // the last locks went missing
+    }
+}
+
+void Versus::handleSnapshot(uint8_t seq, const uint8_t* pBoard) {
+    // a periodic snapshot, or the answer to a request already satisfied:
+    // only useful if the mirror is not ahead of it
+    if (!m_bResyncPending && (int8_t)(seq - m_RemoteSeq) < 0) {
+        return;
+    }
+
+    bool requested = m_bResyncPending;
+
+    // roll the mirror back to the snapshot...
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        m_Mirror[i] = 0;
+
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            int bit = i * BOARD_WIDTH + j;
+
+            if (pBoard[bit / 8] & (1 << (bit % 8))) {
+                m_Mirror[i] |= 1 << j;
+            }
+        }
+    }
+
+    m_RemoteSeq = seq;
+
+    // ...then replay the locks received in the meantime
+    for (;;) {
+        uint8_t next = m_RemoteSeq + 1;
+        const VersusLock* pLock = &m_History[next % VERSUS_HISTORY_LENGTH];
+
+        if (!pLock->valid || pLock->seq != next) {
+            break;
+        }
+
+        applyLock(pLock->bits);
+        m_RemoteSeq = next;
+    }
+
+    m_bResyncPending = false;
+
+    if (!requested) {
+        return;
+    }
+
+    m_LastResyncLatency = millis() - m_ResyncRequestTime;
+
+    if (m_LastResyncLatency > m_MaxResyncLatency) {
+        m_MaxResyncLatency = m_LastResyncLatency;
+    }
+}
+
+// same rules as the local game: place the piece, remove the completed rows, then push the garbage up
+void Versus::applyLock(uint32_t bits) {
+    const Tetromino* pTetromino = &(Pieces[bits & 0x07][(bits >> 3) & 0x03]);
+    int8_t tetrominoX = (bits >> 5) & 0x0F;
+    int8_t tetrominoY = (bits >> 9) & 0x1F;
+    uint8_t garbage = (bits >> 14) & 0x0F;
+    uint8_t hole = (bits >> 18) & 0x0F;
+
+    for (int i = 0; i < 4; i++) {
+        int8_t x = tetrominoX + pTetromino->blocks[i].x;
+        int8_t y = tetrominoY + pTetromino->blocks[i].y;
+
+        if (x >= 0 && x < BOARD_WIDTH && y >= 0 && y < BOARD_HEIGHT) {
+            m_Mirror[y] |= 1 << x;
+        }
+    }
+
+    int rows = 0;
+
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        if (m_Mirror[i] != FULL_ROW) {
+            m_Mirror[rows++] = m_Mirror[i];
+        }
+    }
+
+    for (int i = rows; i < BOARD_HEIGHT; i++) {
+        m_Mirror[i] = 0;
+    }
+
+    if (garbage > 0) {
+        for (int i = BOARD_HEIGHT - 1; i >= garbage; i--) {
+            m_Mirror[i] = m_Mirror[i - garbage];
+        }
+
+        for (int i = 0; i < garbage; i++) {
+            m_Mirror[i] = FULL_ROW & ~(1 << hole);
+        }
+    }
+}
+
+void Versus::requestResync() {
+    if (m_bResyncPending) {
+        return;
+    }
+
+    m_bResyncPending = true;
+    m_ResyncRequestTime = millis();
+    m_ResyncSentTime = m_ResyncRequestTime;
+    m_ResyncCount++;
+
+    uint8_t message[VERSUS_RESYNC_SIZE];
+    writeHeader(message, VERSUS_MSG_RESYNC);
+    m_pLink->send(message, VERSUS_RESYNC_SIZE);
+}
+
+void Versus::sendHeartbeat() {
+    uint8_t board[PACKED_BOARD_SIZE];
+    m_pGame->packBoard(board);
+
+    uint16_t sum = checksum(board, PACKED_BOARD_SIZE);
+    uint8_t message[VERSUS_HEARTBEAT_SIZE];
+
+    writeHeader(message, VERSUS_MSG_HEARTBEAT);
+    message[3] = m_LocalSeq;
+    message[4] = sum & 0xFF;
+    message[5] = sum >> 8;
+    message[6] = m_GarbageSent & 0xFF;
+    message[7] = m_GarbageSent >> 8;
+
+    m_pLink->send(message, VERSUS_HEARTBEAT_SIZE);
+    m_LastHeartbeat = millis();
+}
+
+void Versus::sendSnapshot() {
+    uint8_t message[VERSUS_SNAPSHOT_SIZE];
+
+    writeHeader(message, VERSUS_MSG_SNAPSHOT);
+    message[3] = m_LocalSeq;
+    m_pGame->packBoard(&message[4]);
+
+    m_pLink->send(message, VERSUS_SNAPSHOT_SIZE);
+    m_LastSnapshot = millis();
+}
+
+void Versus::sendGarbage() {
+    uint8_t message[VERSUS_GARBAGE_SIZE];
+
+    writeHeader(message, VERSUS_MSG_GARBAGE);
+    message[3] = m_GarbageSent & 0xFF;
+    message[4] = m_GarbageSent >> 8;
+
+    m_pLink->send(message, VERSUS_GARBAGE_SIZE);
+}
+
+void Versus::writeHeader(uint8_t* pMessage, VersusMessageType type) const {
+    pMessage[0] = type | (m_bToppedOut ? VERSUS_FLAG_TOPPED_OUT : 0);
+    pMessage[1] = m_MatchId;
+    pMessage[2] = m_RemoteMatchId;
+}
+
+void Versus::packMirror(uint8_t* pData) const {
+    memset(pData, 0, PACKED_BOARD_SIZE);
+
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            if (m_Mirror[i] & (1 << j)) {
+                int bit = i * BOARD_WIDTH + j;
+                pData[bit / 8] |= 1 << (bit % 8);
+            }
+        }
+    }
+}
+
+// CRC-16/CCITT
+uint16_t Versus::checksum(const uint8_t* pData, size_t length) {
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= pData[i] << 8;
+
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+    return crc;
+}
@@ -0,0 +1,85 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <Arduino.h>
+
+#include "game.h"
+
+// reaches into a Game for the tests, as Benchmark does for the measurements
+class GameTest {
+public:
+    explicit GameTest(Game* pGame) : m_pGame(pGame) {}
+
+    void load(const bool board[BOARD_HEIGHT][BOARD_WIDTH]) {
+        memcpy(m_pGame->m_Board, board, sizeof(m_pGame->m_Board));
+
+        for (int i = 0; i < BOARD_HEIGHT; i++) {
+            m_pGame->m_Completed[i] = false;
+        }
+    }
+
+    void spawn(TetrominoType type, TetrominoRotation rotation, int8_t x, int8_t y) {
+        m_pGame->m_TetrominoType = type;
+        m_pGame->m_TetrominoRotation = rotation;
+        m_pGame->m_TetrominoX = x;
+        m_pGame->m_TetrominoY = y;
+        m_pGame->m_pTetromino = &(Pieces[type][rotation]);
+    }
+
+    bool (*board())[BOARD_WIDTH] { return m_pGame->m_Board; }
+    const Tetromino* tetromino() const { return m_pGame->m_pTetromino; }
+    TetrominoType type() const { return m_pGame->m_TetrominoType; }
+    TetrominoRotation rotation() const { return m_pGame->m_TetrominoRotation; }
+    int8_t x() const { return m_pGame->m_TetrominoX; }
+    int8_t y() const { return m_pGame->m_TetrominoY; }
+
+    void clear() { m_pGame->clear(); }
+    bool newPiece() { return m_pGame->newTetromino(); }
+    bool overlaps() { return m_pGame->tetrominoOverlaps(); }
+    bool move(int8_t deltaX, int8_t deltaY = 0) { return m_pGame->moveTetromino(deltaX, deltaY); }
+    bool rotate() { return m_pGame->rotateTetromino(); }
+    bool rotateInPlace() { // rotateTetromino as it was before the rule policies
+        const Tetromino* pTetromino = &(Pieces[m_pGame->m_TetrominoType][(m_pGame->m_TetrominoRotation + 1) % ROTATION_COUNT]);
+
+        if (m_pGame->tetrominoOverlaps(pTetromino)) {
+            return false;
+        }
+
+        m_pGame->m_TetrominoRotation = static_cast<TetrominoRotation>((m_pGame->m_TetrominoRotation + 1) % ROTATION_COUNT);
+        m_pGame->m_pTetromino = pTetromino;
+
+        return true;
+    }
+    bool hold() { return m_pGame->holdTetromino(); }
+    void place() { m_pGame->placeTetromino(); }
+    bool clearCompletedRows() { return m_pGame->clearCompletedRows(); }
+    void addGarbage(uint8_t lines, uint8_t hole) { m_pGame->addGarbage(lines, hole); }
+    void compactBoard() { m_pGame->compactBoard(); }
+    void render() { m_pGame->render(Game::RENDER_MODE_PLAYING); }
+
+private:
+    Game* m_pGame;
+};
@@ -0,0 +1,93 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <unity.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "benchmark.h"
+
+// the benchmark on the PC, against the report of a previous run on the same kind of machine
+// run it with BENCHMARK_UPDATE=1 to write the report of this run as the new baseline
+
+#define BASELINE_PATH "test/test_benchmark/baseline.json" // from the project directory
+#define BENCHMARK_ATTEMPTS 3
+
+// keeps the report, and shows it
+class ReportPrint : public Print {
+public:
+    size_t write(uint8_t c) override {
+        m_Text += (char)c;
+        return fwrite(&c, 1, 1, stdout);
+    }
+
+    const std::string& text() const { return m_Text; }
+
+private:
+    std::string m_Text;
+};
+
+static Benchmark s_Benchmark;
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_no_regression() {
+    std::ifstream in(BASELINE_PATH);
+    std::stringstream baseline;
+    baseline << in.rdbuf();
+
+    ReportPrint report;
+    bool passed = s_Benchmark.run(&report, baseline.str().c_str());
+
+    // a PC is a shared machine: a real regression shows on every run, a busy moment does not
+    for (int attempt = 1; attempt < BENCHMARK_ATTEMPTS && !passed; attempt++) {
+        report = ReportPrint();
+        passed = s_Benchmark.run(&report, baseline.str().c_str());
+    }
+
+    if (getenv("BENCHMARK_UPDATE") != NULL) {
+        std::ofstream(BASELINE_PATH) << report.text();
+        TEST_MESSAGE("baseline updated");
+        return;
+    }
+
+    TEST_ASSERT_TRUE_MESSAGE(in.good(), "no baseline, run with BENCHMARK_UPDATE=1");
+    // a baseline for other rules or another CPU frequency is ignored: every path would be new
+    TEST_ASSERT_TRUE_MESSAGE(report.text().find("\"status\":\"new\"") == std::string::npos, "baseline out of date, run with BENCHMARK_UPDATE=1");
+    TEST_ASSERT_TRUE_MESSAGE(passed, "a path regressed");
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_regression);
+
+    return UNITY_END();
+}
@@ -0,0 +1,137 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <unity.h>
+
+#include "benchmark.h"
+#include "../game_test.h"
+
+// the Game board paths against straightforward reference implementations, on the boards of the benchmark
+
+static Benchmark s_Benchmark;
+static NullRenderer s_Renderer;
+static Joystick s_Joystick;
+static Game s_Game(&s_Joystick, &s_Renderer);
+static GameTest s_Test(&s_Game);
+
+static bool referenceOverlaps(const bool board[BOARD_HEIGHT][BOARD_WIDTH], const Tetromino* pTetromino, int8_t x, int8_t y) {
+    for (int i = 0; i < 4; i++) {
+        int bx = x + pTetromino->blocks[i].x;
+        int by = y + pTetromino->blocks[i].y;
+
+        if (bx < 0 || bx >= BOARD_WIDTH || by < 0 || by >= BOARD_HEIGHT || board[by][bx]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_corpus_is_reproducible() {
+    Benchmark other;
+    other.generateCorpus();
+
+    for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+        TEST_ASSERT_EQUAL_MEMORY(s_Benchmark.board(b), other.board(b), sizeof(Benchmark::Board));
+    }
+}
+
+void test_overlaps_match_reference() {
+    for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+        s_Test.load(s_Benchmark.board(b));
+
+        for (int t = 0; t < TETROMINO_COUNT; t++) {
+            for (int r = 0; r < ROTATION_COUNT; r++) {
+                for (int8_t x = -2; x < BOARD_WIDTH + 2; x++) {
+                    for (int8_t y = 0; y < BOARD_HEIGHT; y++) {
+                        char message[64];
+                        snprintf(message, sizeof(message), "board %d piece %d rotation %d at %d,%d", b, t, r, x, y);
+
+                        s_Test.spawn(static_cast<TetrominoType>(t), static_cast<TetrominoRotation>(r), x, y);
+                        TEST_ASSERT_EQUAL_MESSAGE(referenceOverlaps(s_Benchmark.board(b), s_Test.tetromino(), x, y), s_Test.overlaps(), message);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void test_rows_match_reference() {
+    for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+        bool expected[BOARD_HEIGHT][BOARD_WIDTH] = {};
+        int rows = 0;
+        char message[32];
+        snprintf(message, sizeof(message), "board %d", b);
+
+        s_Test.load(s_Benchmark.board(b));
+        Benchmark::completeRows(s_Test.board(), b);
+
+        // reference: keep the rows that are not full, in order, from the bottom
+        for (int i = 0; i < BOARD_HEIGHT; i++) {
+            bool full = true;
+
+            for (int j = 0; j < BOARD_WIDTH; j++) {
+                full = full && s_Test.board()[i][j];
+            }
+
+            if (!full) {
+                memcpy(expected[rows++], s_Test.board()[i], BOARD_WIDTH);
+            }
+        }
+
+        TEST_ASSERT_TRUE_MESSAGE(s_Test.clearCompletedRows(), message);
+
+        s_Test.compactBoard();
+
+        TEST_ASSERT_EQUAL_MEMORY_MESSAGE(expected, s_Test.board(), sizeof(expected), message);
+    }
+}
+
+void test_no_rows_to_clear() {
+    for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+        s_Test.load(s_Benchmark.board(b)); // the corpus is compacted already
+
+        TEST_ASSERT_FALSE(s_Test.clearCompletedRows());
+    }
+}
+
+int main() {
+    s_Benchmark.generateCorpus();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_corpus_is_reproducible);
+    RUN_TEST(test_overlaps_match_reference);
+    RUN_TEST(test_rows_match_reference);
+    RUN_TEST(test_no_rows_to_clear);
+
+    return UNITY_END();
+}
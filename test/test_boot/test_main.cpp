@@ -0,0 +1,114 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <Native.h>
+#include <unity.h>
+
+#include "boot.h"
+#include "game.h"
+#include "renderer.h"
+
+// the fast boot of main.cpp against the recording I2C bus of the shim: what goes on the wire, and when
+
+#define SCREEN_ADDRESS 0x3C
+
+// what Adafruit_SSD1306::begin(SSD1306_SWITCHCAPVCC) sends to a 128x64 panel, one transmission instead of many
+static const uint8_t INIT_BYTES[] = {
+    0x00, 0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00, 0xA1,
+    0xC8, 0xDA, 0x12, 0x81, 0xCF, 0xD9, 0xF1, 0xDB, 0x40, 0xA4, 0xA6, 0x2E, 0xAF
+};
+
+// the frame after the init: the window, then the framebuffer in chunks of the transmit buffer
+static const uint8_t WINDOW_BYTES[] = { 0x00, 0x22, 0x00, 0xFF, 0x21, 0x00, 0x7F };
+#define FRAME_TRANSMISSIONS (1 + (128 * 64 / 8 + 126) / 127)
+
+void setUp() {
+    Native::clearTransmissions();
+}
+
+void tearDown() {
+}
+
+void test_init_is_one_transmission() {
+    FastSSD1306 display(128, 64, &Wire, -1);
+
+    TEST_ASSERT_TRUE(display.beginFast(SCREEN_ADDRESS));
+
+    const std::vector<Native::Transmission>& sent = Native::transmissions();
+    TEST_ASSERT_EQUAL(1, sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SCREEN_ADDRESS, sent[0].address);
+    TEST_ASSERT_EQUAL(sizeof(INIT_BYTES), sent[0].data.size());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(INIT_BYTES, sent[0].data.data(), sizeof(INIT_BYTES));
+
+    // set up as begin() would have, for display()
+    display.display();
+    TEST_ASSERT_EQUAL(1 + FRAME_TRANSMISSIONS, sent.size());
+    TEST_ASSERT_EQUAL_HEX8(SCREEN_ADDRESS, sent[1].address);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(WINDOW_BYTES, sent[1].data.data(), sizeof(WINDOW_BYTES));
+}
+
+// a profiler that also notes how many transmissions went out when each stage was reached
+class RecordingProfiler : public BootProfiler {
+public:
+    size_t sent[BOOT_STAGE_COUNT];
+
+    void mark(BootStage stage) override {
+        sent[stage] = Native::transmissions().size();
+        BootProfiler::mark(stage);
+    }
+};
+
+void test_fast_boot_order() {
+    RecordingProfiler boot;
+    FastSSD1306 display(128, 64, &Wire, -1);
+    SSD1306Renderer renderer(&display);
+    Joystick joystick;
+    Game game(&joystick, &renderer);
+
+    // the stages of setup() with FAST_BOOT
+    boot.mark(BOOT_STAGE_SETUP);
+    TEST_ASSERT_TRUE(fastBoot(&boot, &Wire, &display, SCREEN_ADDRESS, &renderer, &joystick, &game));
+    boot.mark(BOOT_STAGE_READY);
+
+    TEST_ASSERT_TRUE(boot.inOrder());
+
+    // nothing on the bus before the display, the init alone for it, then a whole frame before the serial port
+    TEST_ASSERT_EQUAL(0, boot.sent[BOOT_STAGE_I2C]);
+    TEST_ASSERT_EQUAL(1, boot.sent[BOOT_STAGE_DISPLAY]);
+    TEST_ASSERT_EQUAL(1 + FRAME_TRANSMISSIONS, boot.sent[BOOT_STAGE_FIRST_FRAME]);
+    TEST_ASSERT_EQUAL(1 + FRAME_TRANSMISSIONS, boot.sent[BOOT_STAGE_TASKS]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(INIT_BYTES, Native::transmissions()[0].data.data(), sizeof(INIT_BYTES));
+
+    boot.report();
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_init_is_one_transmission);
+    RUN_TEST(test_fast_boot_order);
+
+    return UNITY_END();
+}
@@ -0,0 +1,204 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <unity.h>
+#include <fstream>
+#include <string>
+
+#include "benchmark.h"
+#include "dataset.h"
+#include "../game_test.h"
+
+// the dataset written across boots, as main.cpp appends it to the file, read back with DatasetReader
+// run it with DATASET_FILE=path to keep the file, e.g. for tools/dataset.py
+
+// the file on the flash filesystem: what is written, and how many times it reached the flash
+class File : public Print {
+public:
+    File() : m_Flushes(0) {}
+
+    size_t write(uint8_t c) override {
+        m_Data += (char)c;
+        return 1;
+    }
+
+    size_t write(const uint8_t* pBuffer, size_t size) override {
+        m_Data.append((const char*)pBuffer, size);
+        return size;
+    }
+
+    void flush() override { m_Flushes++; }
+
+    size_t size() const { return m_Data.size(); }
+    const uint8_t* data() const { return (const uint8_t*)m_Data.data(); }
+    void truncate(size_t size) { m_Data.resize(size); }
+    uint32_t flushes() const { return m_Flushes; }
+
+private:
+    std::string m_Data;
+    uint32_t m_Flushes;
+};
+
+static Benchmark s_Benchmark;
+static Joystick s_Joystick;
+
+// records n placements on the boards of the benchmark, the record i has its x at i % BOARD_WIDTH
+static void record(DatasetWriter* pWriter, int first, int n) {
+    Game game(&s_Joystick, NULL);
+    GameTest test(&game);
+    uint8_t board[PACKED_BOARD_SIZE];
+
+    for (int i = first; i < first + n; i++) {
+        test.load(s_Benchmark.board(i % BENCHMARK_BOARDS));
+        game.packBoard(board);
+        TEST_ASSERT_TRUE(pWriter->add(board, static_cast<TetrominoType>(i % TETROMINO_COUNT), static_cast<TetrominoRotation>(i % ROTATION_COUNT), i % BOARD_WIDTH, i % BOARD_HEIGHT, i % 5));
+    }
+}
+
+static void checkRecords(const File& file, int n) {
+    DatasetReader reader(file.data(), file.size());
+    Game game(&s_Joystick, NULL);
+    GameTest test(&game);
+    uint8_t board[PACKED_BOARD_SIZE];
+    int i = 0;
+
+    TEST_ASSERT_TRUE(reader.valid());
+    TEST_ASSERT_EQUAL(0, (file.size() - DATASET_HEADER_SIZE) % DATASET_CHUNK_SIZE);
+
+    for (size_t chunk = 0; chunk < reader.chunks(); chunk++) {
+        for (uint16_t index = 0; index < reader.chunkRecords(chunk); index++, i++) {
+            DatasetRecord record;
+            TEST_ASSERT_TRUE(reader.record(chunk, index, &record));
+
+            test.load(s_Benchmark.board(i % BENCHMARK_BOARDS));
+            game.packBoard(board);
+            TEST_ASSERT_EQUAL_MEMORY(board, record.pBoard, PACKED_BOARD_SIZE);
+            TEST_ASSERT_EQUAL(i % TETROMINO_COUNT, record.type);
+            TEST_ASSERT_EQUAL(i % ROTATION_COUNT, record.rotation);
+            TEST_ASSERT_EQUAL(i % BOARD_WIDTH, record.x);
+            TEST_ASSERT_EQUAL(i % BOARD_HEIGHT, record.y);
+            TEST_ASSERT_EQUAL(i % 5, record.lines);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(n, i);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_header_once_across_boots() {
+    File file;
+
+    // three boots with a match each, the last chunk of each is partial
+    for (int boot = 0; boot < 3; boot++) {
+        DatasetWriter writer(&file);
+
+        TEST_ASSERT_TRUE(writer.begin(file.size()));
+        record(&writer, boot * 100, 100);
+        TEST_ASSERT_TRUE(writer.flush());
+        TEST_ASSERT_EQUAL(100, writer.records());
+    }
+
+    TEST_ASSERT_EQUAL(DATASET_HEADER_SIZE + 6 * DATASET_CHUNK_SIZE, file.size());
+    TEST_ASSERT_EQUAL(0, memcmp(file.data() + DATASET_HEADER_SIZE + DATASET_CHUNK_SIZE - DATASET_CHUNK_TRAILER_SIZE, "\x40\x00" "CK", 4)); // a full chunk
+    checkRecords(file, 300);
+
+    if (getenv("DATASET_FILE") != NULL) {
+        std::ofstream(getenv("DATASET_FILE"), std::ios::binary).write((const char*)file.data(), file.size());
+    }
+}
+
+void test_flush_reaches_the_output() {
+    File file;
+    DatasetWriter writer(&file);
+
+    TEST_ASSERT_TRUE(writer.begin());
+    record(&writer, 0, DATASET_CHUNK_RECORDS); // a full chunk is written and flushed
+    TEST_ASSERT_EQUAL(1, file.flushes());
+
+    record(&writer, DATASET_CHUNK_RECORDS, 1);
+    TEST_ASSERT_EQUAL(DATASET_HEADER_SIZE + DATASET_CHUNK_SIZE, file.size());
+    TEST_ASSERT_TRUE(writer.flush()); // the end of a match
+    TEST_ASSERT_EQUAL(2, file.flushes());
+    TEST_ASSERT_EQUAL(DATASET_HEADER_SIZE + 2 * DATASET_CHUNK_SIZE, file.size());
+
+    TEST_ASSERT_TRUE(writer.flush()); // nothing left, but the output is flushed all the same
+    TEST_ASSERT_EQUAL(3, file.flushes());
+    TEST_ASSERT_EQUAL(DATASET_HEADER_SIZE + 2 * DATASET_CHUNK_SIZE, file.size());
+}
+
+void test_chunk_cut_short() {
+    // the power goes off in the middle of the chunk, and one byte before its end
+    static const size_t CUTS[] = { DATASET_CHUNK_SIZE / 2, DATASET_CHUNK_SIZE - 1 };
+
+    for (size_t cut = 0; cut < sizeof(CUTS) / sizeof(CUTS[0]); cut++) {
+        File file;
+        DatasetWriter writer(&file);
+
+        TEST_ASSERT_TRUE(writer.begin());
+        record(&writer, 0, DATASET_CHUNK_RECORDS);
+        file.truncate(DATASET_HEADER_SIZE + CUTS[cut]);
+
+        // the next boot pads it, and its chunks are where the reader expects them
+        DatasetWriter next(&file);
+        TEST_ASSERT_TRUE(next.begin(file.size()));
+        TEST_ASSERT_EQUAL(DATASET_HEADER_SIZE + DATASET_CHUNK_SIZE, file.size());
+        record(&next, 0, 10);
+        TEST_ASSERT_TRUE(next.flush());
+
+        // the padded chunk holds no records, not 64 empty ones
+        DatasetReader reader(file.data(), file.size());
+        DatasetRecord record;
+        TEST_ASSERT_EQUAL(2, reader.chunks());
+        TEST_ASSERT_EQUAL(0, reader.chunkRecords(0));
+        TEST_ASSERT_FALSE(reader.record(0, 0, &record));
+        TEST_ASSERT_EQUAL(10, reader.chunkRecords(1));
+        TEST_ASSERT_TRUE(reader.record(1, 9, &record));
+        TEST_ASSERT_EQUAL(9, record.x);
+    }
+
+    File file;
+
+    // a header cut short cannot be appended to
+    file.truncate(DATASET_HEADER_SIZE - 1);
+    DatasetWriter broken(&file);
+    TEST_ASSERT_FALSE(broken.begin(file.size()));
+}
+
+int main() {
+    s_Benchmark.generateCorpus();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_header_once_across_boots);
+    RUN_TEST(test_flush_reaches_the_output);
+    RUN_TEST(test_chunk_cut_short);
+
+    return UNITY_END();
+}
@@ -0,0 +1,265 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <Native.h>
+#include <unity.h>
+#include <atomic>
+#include <vector>
+
+#include "benchmark.h"
+#include "hint.h"
+#include "joystick.h"
+#include "renderer.h"
+#include "../game_test.h"
+
+// the search task against the game task, in virtual time: the clock only moves once every task waits,
+// so a search always completes before the next fall of the piece
+
+#define BURST_REQUESTS 500
+
+// the time of every frame, and whether a hint was there to be drawn
+class FrameLog : public CanvasRenderer {
+public:
+    struct Frame {
+        uint64_t micros;
+        bool hint;
+    };
+
+    explicit FrameLog(HintEngine* pHint) : m_pHint(pHint) {}
+
+    std::vector<Frame> frames;
+
+protected:
+    void show() override {
+        int8_t x, y;
+        TetrominoRotation rotation;
+        Frame frame = { Native::now(), m_pHint->result(&x, &y, &rotation) };
+
+        frames.push_back(frame);
+    }
+
+private:
+    HintEngine* m_pHint;
+};
+
+static Benchmark s_Benchmark;
+static Joystick s_Joystick;
+static HintEngine s_Hint(&s_Joystick);
+
+// the hint is a resting place of the piece on the board it was asked for
+static void checkPlacement(const bool board[BOARD_HEIGHT][BOARD_WIDTH], TetrominoType type) {
+    int8_t x, y;
+    TetrominoRotation rotation;
+    Game game(&s_Joystick, NULL);
+    GameTest test(&game);
+
+    TEST_ASSERT_TRUE(s_Hint.result(&x, &y, &rotation));
+
+    test.load(board);
+    test.spawn(type, rotation, x, y);
+    TEST_ASSERT_FALSE(test.overlaps());
+    TEST_ASSERT_FALSE(test.move(0, -1));
+}
+
+// as for a piece just spawned on board b of the benchmark
+static int request(int b) {
+    s_Hint.request(s_Benchmark.board(b), static_cast<TetrominoType>(b % TETROMINO_COUNT), BOARD_HEIGHT - 1);
+
+    return b;
+}
+
+// whether the piece of request(b) fits anywhere at its height, on the fuller boards it does not
+static bool reachable(int b) {
+    Game game(&s_Joystick, NULL);
+    GameTest test(&game);
+
+    test.load(s_Benchmark.board(b));
+
+    for (int r = 0; r < ROTATION_COUNT; r++) {
+        for (int8_t x = -2; x < BOARD_WIDTH + 2; x++) {
+            test.spawn(static_cast<TetrominoType>(b % TETROMINO_COUNT), static_cast<TetrominoRotation>(r), x, BOARD_HEIGHT - 1);
+
+            if (!test.overlaps()) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void setUp() {
+    // no leftovers from the previous test
+    Native::advance(1000);
+    while (s_Joystick.waitMove(0) != Joystick::BUTTON_NONE) {
+    }
+}
+
+void tearDown() {
+}
+
+void test_result_wakes_the_game_task() {
+    int reached = 0;
+
+    for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+        request(b);
+        Native::advance(1000); // the search task is done
+
+        if (!reachable(b)) {
+            // no result, nothing to redraw
+            int8_t x, y;
+            TetrominoRotation rotation;
+
+            TEST_ASSERT_FALSE(s_Hint.result(&x, &y, &rotation));
+            TEST_ASSERT_EQUAL(Joystick::BUTTON_NONE, s_Joystick.waitMove(0));
+            continue;
+        }
+
+        TEST_ASSERT_EQUAL(Joystick::BUTTON_REDRAW, s_Joystick.waitMove(0));
+        TEST_ASSERT_EQUAL(Joystick::BUTTON_NONE, s_Joystick.waitMove(0));
+        checkPlacement(s_Benchmark.board(b), static_cast<TetrominoType>(b % TETROMINO_COUNT));
+        reached++;
+    }
+
+    TEST_ASSERT_GREATER_THAN(1, reached);
+}
+
+void test_button_goes_first() {
+    s_Joystick.enable();
+    s_Joystick.requestRedraw();
+
+    Native::setPin(PIN_BUTTON_LEFT, HIGH);
+    Native::advance((JOYSTICK_DEBOUNCE + 2 * JOYSTICK_POLL) * 1000);
+
+    // the press is not lost, and neither is the redraw
+    TEST_ASSERT_EQUAL(Joystick::BUTTON_LEFT, s_Joystick.waitMove(0));
+    TEST_ASSERT_EQUAL(Joystick::BUTTON_REDRAW, s_Joystick.waitMove(0));
+    TEST_ASSERT_EQUAL(Joystick::BUTTON_NONE, s_Joystick.waitMove(0));
+
+    Native::setPin(PIN_BUTTON_LEFT, LOW);
+    Native::advance((JOYSTICK_DEBOUNCE + 2 * JOYSTICK_POLL) * 1000);
+    s_Joystick.disable();
+}
+
+void test_newest_request_wins() {
+    int b = 0;
+
+    // requests as fast as the game task can post them, while the search task is running
+    for (int i = 0; i < BURST_REQUESTS; i++) {
+        if (!reachable(i % BENCHMARK_BOARDS)) {
+            continue;
+        }
+
+        b = request(i % BENCHMARK_BOARDS);
+
+        int8_t x, y;
+        TetrominoRotation rotation;
+
+        if (s_Hint.result(&x, &y, &rotation)) {
+            // never the result of an older request
+            checkPlacement(s_Benchmark.board(b), static_cast<TetrominoType>(b % TETROMINO_COUNT));
+        }
+    }
+
+    Native::advance(1000);
+
+    int8_t x, y;
+    TetrominoRotation rotation;
+    TEST_ASSERT_TRUE(s_Hint.result(&x, &y, &rotation));
+    checkPlacement(s_Benchmark.board(b), static_cast<TetrominoType>(b % TETROMINO_COUNT));
+
+    // the same as a search that was never interrupted
+    request(b);
+    Native::advance(1000);
+
+    int8_t alone_x, alone_y;
+    TetrominoRotation alone_rotation;
+    TEST_ASSERT_TRUE(s_Hint.result(&alone_x, &alone_y, &alone_rotation));
+    TEST_ASSERT_EQUAL(alone_x, x);
+    TEST_ASSERT_EQUAL(alone_y, y);
+    TEST_ASSERT_EQUAL(alone_rotation, rotation);
+}
+
+static std::atomic<bool> s_bMatchOver(false);
+
+static void matchTask(void* pvParameters) {
+    static_cast<Game*>(pvParameters)->playMatch();
+    s_bMatchOver = true;
+
+    vTaskDelete(NULL);
+}
+
+void test_match_redraws_on_hints() {
+    FrameLog log(&s_Hint);
+    Game game(&s_Joystick, &log);
+
+    TEST_ASSERT_TRUE(log.begin());
+    game.seed(42);
+    game.setHint(&s_Hint);
+
+    // nobody at the controls: the pieces fall until the stack tops out
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(matchTask, "Match Task", 8192, &game, 1, NULL));
+
+    for (int i = 0; i < 10000 && !s_bMatchOver; i++) {
+        Native::advance(FALLING_SPEED * 1000 / 4);
+    }
+
+    TEST_ASSERT_TRUE(s_bMatchOver);
+
+    // each position of the piece is drawn at least twice: when it gets there, and when its hint comes in
+    uint32_t positions = 0, redrawn = 0;
+
+    for (size_t i = 0; i < log.frames.size(); i++) {
+        if (i + 1 == log.frames.size() || log.frames[i + 1].micros != log.frames[i].micros) {
+            positions++;
+            redrawn += (i > 0 && log.frames[i - 1].micros == log.frames[i].micros && log.frames[i].hint) ? 1 : 0;
+        }
+    }
+
+    char message[64];
+    snprintf(message, sizeof(message), "%u frames, %u positions, %u redrawn with a hint", (uint32_t)log.frames.size(), positions, redrawn);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_GREATER_THAN(20, positions);
+    TEST_ASSERT_TRUE(log.frames[1].micros == log.frames[0].micros && log.frames[1].hint); // the first piece
+    TEST_ASSERT_GREATER_OR_EQUAL(positions * 9 / 10, redrawn); // not the last ones, there is no room left
+}
+
+int main() {
+    Native::useVirtualTime();
+    s_Benchmark.generateCorpus();
+
+    s_Joystick.begin();
+    s_Hint.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_result_wakes_the_game_task);
+    RUN_TEST(test_button_goes_first);
+    RUN_TEST(test_newest_request_wins);
+    RUN_TEST(test_match_redraws_on_hints);
+
+    return UNITY_END();
+}
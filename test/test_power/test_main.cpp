@@ -0,0 +1,214 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <Native.h>
+#include <unity.h>
+#include <atomic>
+#include <driver/gpio.h>
+#include <functional>
+
+#include "game.h"
+#include "power.h"
+#include "renderer.h"
+
+// the screens of the game played in virtual time against the wakeup budgets of power.h,
+// with a fast player at the buttons: every wakeup of the game tasks is counted, none is modeled
+
+#define PRESSES_PER_SECOND 8 // a fast player
+#define PRESS_HOLD 40 // milliseconds, longer than the debounce
+#define MAX_MATCH_SECONDS 600
+
+static Joystick s_Joystick;
+static Sequencer s_Sequencer;
+static PowerManager s_Power(&s_Joystick, &s_Sequencer);
+static NullRenderer s_Renderer;
+static Game s_Game(&s_Joystick, &s_Renderer);
+
+// a screen of the game, run by a task of its own as loop() does
+typedef struct {
+    std::function<void()> run;
+    std::atomic<bool> done;
+    uint32_t wakeupsPerSecond; // measured as soon as the screen is over
+} Screen;
+
+static void screenTask(void* pvParameters) {
+    Screen* pScreen = static_cast<Screen*>(pvParameters);
+
+    pScreen->run();
+    pScreen->wakeupsPerSecond = s_Power.wakeupsPerSecond();
+    pScreen->done = true;
+
+    vTaskDelete(NULL);
+}
+
+static void start(Screen* pScreen) {
+    pScreen->done = false;
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(screenTask, "Screen Task", 8192, pScreen, 1, NULL));
+    Native::advance(0);
+}
+
+static void press(uint8_t pin, uint32_t milliseconds) {
+    Native::setPin(pin, HIGH);
+    Native::advance(PRESS_HOLD * 1000);
+    Native::setPin(pin, LOW);
+    Native::advance((milliseconds - PRESS_HOLD) * 1000);
+}
+
+static void checkBudget(const char* pScreen, uint32_t wakeupsPerSecond, uint32_t budget) {
+    char message[64];
+    snprintf(message, sizeof(message), "%s: %u wakeups/s, budget %u", pScreen, wakeupsPerSecond, budget);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(budget, wakeupsPerSecond, message);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_armed_wakeup_is_not_an_interrupt() {
+    s_Joystick.enable();
+    s_Joystick.armWakeup();
+
+    TEST_ASSERT_TRUE(Native::wakeupEnabled(PIN_BUTTON_LEFT));
+    TEST_ASSERT_FALSE(Native::interruptEnabled(PIN_BUTTON_LEFT));
+
+    // held down while asleep: the level wakes the chip up, but does not fire the interrupt over and over
+    Native::setPin(PIN_BUTTON_LEFT, HIGH);
+    TEST_ASSERT_FALSE(Native::interruptStorm());
+
+    s_Joystick.disarmWakeup();
+
+    TEST_ASSERT_FALSE(Native::wakeupEnabled(PIN_BUTTON_LEFT));
+    TEST_ASSERT_TRUE(Native::interruptEnabled(PIN_BUTTON_LEFT));
+    TEST_ASSERT_EQUAL(GPIO_INTR_ANYEDGE, Native::interruptType(PIN_BUTTON_LEFT));
+
+    // and the press that woke us up is not lost
+    Native::advance((JOYSTICK_DEBOUNCE + 2 * JOYSTICK_POLL) * 1000);
+    TEST_ASSERT_EQUAL(Joystick::BUTTON_LEFT, s_Joystick.waitMove(0));
+
+    Native::setPin(PIN_BUTTON_LEFT, LOW);
+    Native::advance((JOYSTICK_DEBOUNCE + 2 * JOYSTICK_POLL) * 1000);
+    s_Joystick.disable();
+}
+
+void test_note_wakes_sequencer_twice() {
+    uint32_t wakeups = s_Sequencer.wakeups();
+
+    Native::clearTones();
+    s_Sequencer.post(Sequencer::COMMAND_PLAY_MUSIC);
+    Native::advance(10 * 1000000);
+
+    uint32_t notes = 0;
+
+    for (size_t i = 0; i < Native::tones().size(); i++) {
+        notes += (Native::tones()[i].frequency != 0) ? 1 : 0;
+    }
+
+    // at its start and at its silent last tick; the rests and the commands, at most once a second
+    TEST_ASSERT_GREATER_THAN(30, notes);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * notes + 10, s_Sequencer.wakeups() - wakeups);
+
+    s_Sequencer.post(Sequencer::COMMAND_STOP_MUSIC);
+    Native::advance(1000000);
+    TEST_ASSERT_TRUE(s_Sequencer.silent());
+}
+
+void test_attract_screen() {
+    Screen attract;
+    attract.run = [] { s_Game.waitCoins(); };
+
+    uint32_t sleeps = Native::lightSleeps();
+    start(&attract);
+
+    Native::advance(1000000); // the budget is per second, as in PowerManager::report()
+    TEST_ASSERT_EQUAL(sleeps + 1, Native::lightSleeps()); // asleep until the coin
+
+    press(PIN_BUTTON_ROTATE, 1000 / PRESSES_PER_SECOND);
+    Native::advance(POWER_PRESS_TIMEOUT * 1000);
+
+    TEST_ASSERT_TRUE(attract.done);
+    checkBudget("attract", attract.wakeupsPerSecond, WAKEUP_BUDGET_ATTRACT);
+}
+
+void test_match() {
+    static const uint8_t PINS[] = { PIN_BUTTON_LEFT, PIN_BUTTON_RIGHT, PIN_BUTTON_ROTATE };
+    Screen match;
+    match.run = [] { s_Game.playMatch(); };
+
+    start(&match);
+
+    // buttons as fast as a player can press them, until the stack tops out
+    for (int i = 0; i < MAX_MATCH_SECONDS * PRESSES_PER_SECOND && !match.done; i++) {
+        press(PINS[i % 3], 1000 / PRESSES_PER_SECOND);
+    }
+
+    Native::advance(1000000);
+
+    TEST_ASSERT_TRUE(match.done);
+    checkBudget("playing", match.wakeupsPerSecond, WAKEUP_BUDGET_PLAYING);
+}
+
+void test_game_over_screen() {
+    Screen over;
+    over.run = [] { s_Game.over(); };
+
+    uint32_t sleeps = Native::lightSleeps();
+    start(&over);
+
+    // the effect plays to its end, then the chip sleeps
+    Native::advance(2000000);
+    TEST_ASSERT_TRUE(s_Sequencer.silent());
+    TEST_ASSERT_EQUAL(sleeps + 1, Native::lightSleeps());
+
+    press(PIN_BUTTON_LEFT, 1000 / PRESSES_PER_SECOND);
+    Native::advance(POWER_PRESS_TIMEOUT * 1000);
+
+    TEST_ASSERT_TRUE(over.done);
+    checkBudget("game over", over.wakeupsPerSecond, WAKEUP_BUDGET_GAME_OVER);
+}
+
+int main() {
+    Native::useVirtualTime();
+
+    s_Joystick.begin();
+    s_Sequencer.begin();
+    s_Renderer.begin();
+    s_Game.seed(42);
+    s_Game.setSequencer(&s_Sequencer);
+    s_Game.setPower(&s_Power);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_armed_wakeup_is_not_an_interrupt);
+    RUN_TEST(test_note_wakes_sequencer_twice);
+    RUN_TEST(test_attract_screen);
+    RUN_TEST(test_match);
+    RUN_TEST(test_game_over_screen);
+
+    return UNITY_END();
+}
@@ -0,0 +1,177 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <unity.h>
+
+#include "randomizer.h"
+
+// fixed seeds: a failure is a property of the code, not bad luck
+
+#define RANDOM_COUNT 70000 // outputs drawn for each statistical check
+
+// chi-square critical value for 6 degrees of freedom (seven pieces) at p = 0.001
+#define CHI_SQUARE_LIMIT 22.46f
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_jump_matches_next() {
+    RandomStream stepped(42, 7);
+    RandomStream jumped(42, 7);
+
+    for (int i = 0; i < 1000; i++) {
+        stepped.next();
+    }
+
+    jumped.jump(1000);
+
+    TEST_ASSERT_EQUAL_UINT32(stepped.position(), jumped.position());
+    TEST_ASSERT_EQUAL_UINT32(stepped.next(), jumped.next());
+}
+
+void test_below_stays_in_bounds() {
+    RandomStream random(42);
+
+    for (int i = 0; i < RANDOM_COUNT; i++) {
+        TEST_ASSERT_LESS_THAN(7, random.below(7));
+    }
+}
+
+void test_same_seed_same_pieces() {
+    PieceGenerator first(PieceGenerator::MODE_BAG);
+    PieceGenerator second(PieceGenerator::MODE_BAG);
+    first.seed(42, 7);
+    second.seed(42, 7);
+
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_EQUAL(first.peek(PIECE_PREVIEW - 1), second.peek(PIECE_PREVIEW - 1));
+        TEST_ASSERT_EQUAL(first.next(), second.next());
+    }
+}
+
+void test_mode_and_seed_in_any_order() {
+    for (int mode = 0; mode < PieceGenerator::MODE_COUNT; mode++) {
+        PieceGenerator first(PieceGenerator::MODE_COUNT == mode + 1 ? PieceGenerator::MODE_UNIFORM : PieceGenerator::MODE_BAG);
+        PieceGenerator second(first.mode());
+        first.seed(42, 7);
+        first.setMode((PieceGenerator::Mode)mode);
+        second.setMode((PieceGenerator::Mode)mode);
+        second.seed(42, 7);
+
+        for (int i = 0; i < 1000; i++) {
+            TEST_ASSERT_EQUAL(first.peek(PIECE_PREVIEW - 1), second.peek(PIECE_PREVIEW - 1));
+            TEST_ASSERT_EQUAL(first.next(), second.next());
+        }
+    }
+}
+
+void test_preview_is_what_comes_next() {
+    PieceGenerator pieces(PieceGenerator::MODE_UNIFORM);
+    pieces.seed(42);
+
+    for (int i = 0; i < 1000; i++) {
+        TetrominoType preview[PIECE_PREVIEW];
+
+        for (int p = 0; p < PIECE_PREVIEW; p++) {
+            preview[p] = pieces.peek(p);
+        }
+
+        TEST_ASSERT_EQUAL(preview[0], pieces.next());
+
+        for (int p = 1; p < PIECE_PREVIEW; p++) {
+            TEST_ASSERT_EQUAL(preview[p], pieces.peek(p - 1));
+        }
+    }
+}
+
+void test_uniform_distribution() {
+    PieceGenerator uniform(PieceGenerator::MODE_UNIFORM);
+    uint32_t counts[TETROMINO_COUNT] = {};
+    uniform.seed(42);
+
+    for (int i = 0; i < RANDOM_COUNT; i++) {
+        counts[uniform.next()]++;
+    }
+
+    float expected = (float)RANDOM_COUNT / TETROMINO_COUNT;
+    float chiSquare = 0;
+
+    for (int t = 0; t < TETROMINO_COUNT; t++) {
+        chiSquare += (counts[t] - expected) * (counts[t] - expected) / expected;
+    }
+
+    TEST_ASSERT_LESS_THAN_DOUBLE(CHI_SQUARE_LIMIT, chiSquare);
+}
+
+void test_bags_are_permutations() {
+    PieceGenerator bag(PieceGenerator::MODE_BAG);
+    bag.seed(42);
+
+    for (int i = 0; i < RANDOM_COUNT / TETROMINO_COUNT; i++) {
+        uint8_t seen = 0;
+
+        for (int t = 0; t < TETROMINO_COUNT; t++) {
+            seen |= 1 << bag.next();
+        }
+
+        TEST_ASSERT_EQUAL_HEX8((1 << TETROMINO_COUNT) - 1, seen);
+    }
+}
+
+void test_split_streams_are_uncorrelated() {
+    RandomStream parent(42);
+    RandomStream left = parent.split(0);
+    RandomStream right = parent.split(1);
+    uint32_t agree = 0;
+
+    // about half of the bits agree, as for unrelated sequences
+    for (int i = 0; i < RANDOM_COUNT; i++) {
+        agree += 32 - __builtin_popcount(left.next() ^ right.next());
+    }
+
+    // 16 bits per word on average, the standard deviation over the whole run is sqrt(32 * count) / 2
+    int32_t deviation = (int32_t)agree - 16 * RANDOM_COUNT;
+    int32_t sigma = (int32_t)sqrtf(32.0f * RANDOM_COUNT) / 2;
+
+    TEST_ASSERT_INT_WITHIN(5 * sigma, 0, deviation);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_jump_matches_next);
+    RUN_TEST(test_below_stays_in_bounds);
+    RUN_TEST(test_same_seed_same_pieces);
+    RUN_TEST(test_mode_and_seed_in_any_order);
+    RUN_TEST(test_preview_is_what_comes_next);
+    RUN_TEST(test_uniform_distribution);
+    RUN_TEST(test_bags_are_permutations);
+    RUN_TEST(test_split_streams_are_uncorrelated);
+
+    return UNITY_END();
+}
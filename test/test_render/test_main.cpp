@@ -0,0 +1,271 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <Native.h>
+#include <unity.h>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "renderer.h"
+#include "../game_test.h"
+
+// the frames of a recorded sequence against golden files, and the cost of a frame on every backend
+// run it with RENDER_UPDATE=1 to write the frames of this run as the new golden files
+// text is not rasterized on a PC, so the sequence only has playing frames
+
+#define GOLDEN_PBM "test/test_render/golden.pbm" // from the project directory
+#define GOLDEN_TERMINAL "test/test_render/golden.ans"
+#define PBM_FRAME_SIZE (PLAYSCREEN_WIDTH / 8 * PLAYSCREEN_HEIGHT)
+#define BENCH_FRAMES 200
+
+// keeps what a backend writes, and counts the flushes
+class Capture : public Print {
+public:
+    Capture(bool keep = true) : m_bKeep(keep), m_Flushes(0) {}
+
+    size_t write(uint8_t c) override {
+        if (m_bKeep) {
+            m_Text += (char)c;
+        }
+
+        return 1;
+    }
+
+    size_t write(const uint8_t* pBuffer, size_t size) override {
+        if (m_bKeep) {
+            m_Text.append((const char*)pBuffer, size);
+        }
+
+        return size;
+    }
+
+    void flush() override { m_Flushes++; }
+
+    const std::string& text() const { return m_Text; }
+    uint32_t flushes() const { return m_Flushes; }
+
+private:
+    bool m_bKeep;
+    std::string m_Text;
+    uint32_t m_Flushes;
+};
+
+// pieces of a fixed seed dropped on a board of the benchmark: rotations, then columns to shift
+static const struct {
+    int8_t rotations;
+    int8_t shift;
+} SCRIPT[] = {
+    {0, -4}, {1, 3}, {0, 0}, {2, -2}, {1, 5}, {3, -1}, {0, 2}, {1, -3}
+};
+
+static Benchmark s_Benchmark;
+static Joystick s_Joystick;
+
+// plays the script, a frame after each step
+static uint32_t play(Renderer* pRenderer, const std::function<void()>& frame) {
+    Game game(&s_Joystick, pRenderer);
+    GameTest test(&game);
+    uint32_t frames = 0;
+
+    game.seed(42);
+    test.load(s_Benchmark.board(1));
+
+    for (size_t p = 0; p < sizeof(SCRIPT) / sizeof(SCRIPT[0]) && test.newPiece(); p++) {
+        test.render();
+        frame();
+
+        for (int r = 0; r < SCRIPT[p].rotations; r++) {
+            test.rotate();
+        }
+
+        for (int s = 0; s != SCRIPT[p].shift; s += (SCRIPT[p].shift > 0) ? 1 : -1) {
+            test.move((SCRIPT[p].shift > 0) ? 1 : -1);
+        }
+
+        test.render();
+        frame();
+
+        while (test.move(0, -1)) {
+        }
+
+        test.render();
+        frame();
+        frames += 3;
+
+        test.place();
+
+        if (test.clearCompletedRows()) {
+            test.render(); // the explosion
+            frame();
+            frames++;
+
+            test.compactBoard();
+        }
+    }
+
+    return frames;
+}
+
+static std::string readFile(const char* pPath) {
+    std::ifstream in(pPath, std::ios::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+
+    return text.str();
+}
+
+static void checkGolden(const char* pPath, const std::string& frames) {
+    if (getenv("RENDER_UPDATE") != NULL) {
+        std::ofstream(pPath, std::ios::binary) << frames;
+        TEST_MESSAGE("golden frames updated");
+        return;
+    }
+
+    std::string golden = readFile(pPath);
+
+    TEST_ASSERT_TRUE_MESSAGE(!golden.empty(), "no golden frames, run with RENDER_UPDATE=1");
+    TEST_ASSERT_EQUAL(golden.size(), frames.size());
+    TEST_ASSERT_TRUE_MESSAGE(golden == frames, "the frames differ from the golden ones");
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_pbm_golden_frames() {
+    Capture out;
+    PbmRenderer renderer(&out);
+    TEST_ASSERT_TRUE(renderer.begin());
+
+    uint32_t frames = play(&renderer, [] {});
+
+    TEST_ASSERT_GREATER_THAN(20, frames);
+    TEST_ASSERT_EQUAL(frames * (strlen("P4\n64 128\n") + PBM_FRAME_SIZE), out.text().size());
+    checkGolden(GOLDEN_PBM, out.text());
+
+    // flushed in batches, and what is left at the end of the match
+    TEST_ASSERT_EQUAL(frames / PBM_FLUSH_FRAMES, out.flushes());
+    renderer.report();
+    TEST_ASSERT_EQUAL(frames / PBM_FLUSH_FRAMES + 1, out.flushes());
+}
+
+void test_terminal_golden_frames() {
+    Capture out;
+    TerminalRenderer renderer(&out);
+    TEST_ASSERT_TRUE(renderer.begin());
+
+    play(&renderer, [] {});
+
+    checkGolden(GOLDEN_TERMINAL, out.text());
+}
+
+void test_display_matches_canvas() {
+    // the same sequence on the OLED framebuffer, pixel by pixel against the PBM frames
+    std::string pbm = readFile(GOLDEN_PBM);
+    Adafruit_SSD1306 display(128, 64, &Wire, -1);
+    SSD1306Renderer renderer(&display);
+    uint32_t frame = 0;
+
+    TEST_ASSERT_TRUE(display.begin(SSD1306_SWITCHCAPVCC, 0x3C));
+    display.setRotation(3); // as in main.cpp
+
+    play(&renderer, [&] {
+        const uint8_t* pFrame = (const uint8_t*)pbm.data() + frame * (strlen("P4\n64 128\n") + PBM_FRAME_SIZE) + strlen("P4\n64 128\n");
+
+        TEST_ASSERT_TRUE((frame + 1) * (strlen("P4\n64 128\n") + PBM_FRAME_SIZE) <= pbm.size());
+
+        for (int y = 0; y < PLAYSCREEN_HEIGHT; y++) {
+            for (int x = 0; x < PLAYSCREEN_WIDTH; x++) {
+                bool black = pFrame[y * (PLAYSCREEN_WIDTH / 8) + x / 8] & (0x80 >> (x & 7));
+                TEST_ASSERT_EQUAL(!black, display.getPixel(x, y));
+            }
+        }
+
+        frame++;
+    });
+
+    Native::clearTransmissions();
+}
+
+// what a frame costs on each backend: drawing by the game, then show()
+void test_backend_speed() {
+    Capture discard(false);
+    NullRenderer null;
+    TerminalRenderer terminal(&discard);
+    PbmRenderer pbm(&discard);
+    Adafruit_SSD1306 display(128, 64, &Wire, -1);
+    SSD1306Renderer oled(&display);
+
+    display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+    display.setRotation(3);
+
+    const struct {
+        const char* name;
+        Renderer* pRenderer;
+    } BACKENDS[] = {
+        {"null", &null}, {"terminal", &terminal}, {"pbm", &pbm}, {"ssd1306", &oled}
+    };
+
+    for (size_t i = 0; i < sizeof(BACKENDS) / sizeof(BACKENDS[0]); i++) {
+        Game game(&s_Joystick, BACKENDS[i].pRenderer);
+        GameTest test(&game);
+
+        TEST_ASSERT_TRUE(BACKENDS[i].pRenderer->begin());
+
+        uint32_t startTime = ESP.getCycleCount();
+
+        for (int f = 0; f < BENCH_FRAMES; f++) {
+            test.load(s_Benchmark.board(f % BENCHMARK_BOARDS));
+            test.spawn(static_cast<TetrominoType>(f % TETROMINO_COUNT), ROTATION_0, BOARD_WIDTH / 2 - 1, BOARD_HEIGHT - 1);
+            test.render();
+        }
+
+        uint32_t nanoseconds = ESP.getCycleCount() - startTime;
+        char message[64];
+        snprintf(message, sizeof(message), "%-8s %6u ns per frame", BACKENDS[i].name, nanoseconds / BENCH_FRAMES);
+        TEST_MESSAGE(message);
+
+        Native::clearTransmissions(); // the display writes to the bus on every frame
+    }
+}
+
+int main() {
+    s_Benchmark.generateCorpus();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_pbm_golden_frames);
+    RUN_TEST(test_terminal_golden_frames);
+    RUN_TEST(test_display_matches_canvas);
+    RUN_TEST(test_backend_speed);
+
+    return UNITY_END();
+}
@@ -0,0 +1,201 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <Native.h>
+#include <unity.h>
+
+#include "benchmark.h"
+#include "rules.h"
+#include "../game_test.h"
+
+// the rule policies: the SRS kicks against the offset tables they come from,
+// and the plain rotation of this build against the rotation from before the policies
+// the cost of the rotation is timed by test_benchmark, against its baseline
+
+static Benchmark s_Benchmark;
+static NullRenderer s_Renderer;
+static Joystick s_Joystick;
+static Game s_Game(&s_Joystick, &s_Renderer);
+static GameTest s_Test(&s_Game);
+
+// the SRS offsets of each state, y up as on the board: a kick from A to B is offset(A) - offset(B),
+// less the first one, which only moves the I back to the rotation center of the Pieces table
+enum SrsState { SRS_0 = 0, SRS_R, SRS_2, SRS_L };
+
+static const Point OFFSETS_JLSTZ[4][RotationSrs::KICKS] = {
+    { {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0} },
+    { {0, 0}, {1, 0}, {1, -1}, {0, 2}, {1, 2} },
+    { {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0} },
+    { {0, 0}, {-1, 0}, {-1, -1}, {0, 2}, {-1, 2} }
+};
+
+static const Point OFFSETS_I[4][RotationSrs::KICKS] = {
+    { {0, 0}, {-1, 0}, {2, 0}, {-1, 0}, {2, 0} },
+    { {-1, 0}, {0, 0}, {0, 0}, {0, 1}, {0, -2} },
+    { {-1, 1}, {1, 1}, {-2, 1}, {1, 0}, {-2, 0} },
+    { {0, 1}, {0, 1}, {0, 1}, {0, -1}, {0, 2} }
+};
+
+// the rotations of the Pieces table go counterclockwise: 0, L, 2, R
+static const SrsState STATES[ROTATION_COUNT] = { SRS_0, SRS_L, SRS_2, SRS_R };
+
+static Point srsKick(const Point offsets[4][RotationSrs::KICKS], TetrominoRotation from, uint8_t index) {
+    const Point* pFrom = offsets[STATES[from]];
+    const Point* pTo = offsets[STATES[(from + 1) % ROTATION_COUNT]];
+
+    return { (int8_t)((pFrom[index].x - pTo[index].x) - (pFrom[0].x - pTo[0].x)),
+             (int8_t)((pFrom[index].y - pTo[index].y) - (pFrom[0].y - pTo[0].y)) };
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_srs_kicks_match_the_offsets() {
+    char message[64];
+
+    for (int t = 0; t < TETROMINO_COUNT; t++) {
+        if (t == TETROMINO_O) {
+            continue; // never kicked
+        }
+
+        for (int r = 0; r < ROTATION_COUNT; r++) {
+            for (uint8_t i = 0; i < RotationSrs::KICKS; i++) {
+                Point expected = srsKick((t == TETROMINO_I) ? OFFSETS_I : OFFSETS_JLSTZ, static_cast<TetrominoRotation>(r), i);
+                Point kick = RotationSrs::kick(static_cast<TetrominoType>(t), static_cast<TetrominoRotation>(r), i);
+                snprintf(message, sizeof(message), "type %d, rotation %d, kick %u", t, r, i);
+
+                TEST_ASSERT_EQUAL_MESSAGE(expected.x, kick.x, message);
+                TEST_ASSERT_EQUAL_MESSAGE(expected.y, kick.y, message);
+            }
+        }
+    }
+}
+
+void test_i_kicks_from_l_to_2() {
+    static const Point EXPECTED[RotationSrs::KICKS] = { {0, 0}, {-2, 0}, {1, 0}, {-2, -1}, {1, 2} };
+
+    for (uint8_t i = 0; i < RotationSrs::KICKS; i++) {
+        Point kick = RotationSrs::kick(TETROMINO_I, ROTATION_90, i);
+
+        TEST_ASSERT_EQUAL(EXPECTED[i].x, kick.x);
+        TEST_ASSERT_EQUAL(EXPECTED[i].y, kick.y);
+    }
+}
+
+void test_plain_rotation_is_in_place() {
+    for (int i = 0; i < RotationPlain::KICKS; i++) {
+        Point kick = RotationPlain::kick(TETROMINO_T, ROTATION_0, i);
+
+        TEST_ASSERT_EQUAL(0, kick.x);
+        TEST_ASSERT_EQUAL(0, kick.y);
+    }
+
+    TEST_ASSERT_EQUAL(1, RotationPlain::KICKS);
+}
+
+void test_plain_rotation_as_before_the_policies() {
+    if (RulesRotation::KICKS != RotationPlain::KICKS) {
+        TEST_IGNORE_MESSAGE("a build with kicks");
+    }
+
+    Game other(&s_Joystick, &s_Renderer);
+    GameTest reference(&other);
+
+    for (int b = 0; b < BENCHMARK_BOARDS; b++) {
+        s_Test.load(s_Benchmark.board(b));
+        reference.load(s_Benchmark.board(b));
+
+        for (int t = 0; t < TETROMINO_COUNT; t++) {
+            for (int8_t y = 0; y < BOARD_HEIGHT; y++) {
+                for (int8_t x = -1; x < BOARD_WIDTH; x++) {
+                    s_Test.spawn(static_cast<TetrominoType>(t), ROTATION_0, x, y);
+                    reference.spawn(static_cast<TetrominoType>(t), ROTATION_0, x, y);
+
+                    for (int r = 0; r < ROTATION_COUNT; r++) {
+                        TEST_ASSERT_EQUAL(reference.rotateInPlace(), s_Test.rotate());
+                        TEST_ASSERT_EQUAL(reference.rotation(), s_Test.rotation());
+                        TEST_ASSERT_EQUAL(reference.x(), s_Test.x());
+                        TEST_ASSERT_EQUAL(reference.y(), s_Test.y());
+                    }
+                }
+            }
+        }
+    }
+}
+
+void test_held_piece_is_drawn() {
+    Adafruit_SSD1306 display(128, 64, &Wire, -1);
+    SSD1306Renderer renderer(&display);
+    Game game(&s_Joystick, &renderer);
+    GameTest test(&game);
+
+    TEST_ASSERT_TRUE(display.begin(SSD1306_SWITCHCAPVCC, 0x3C));
+    display.setRotation(3); // as in main.cpp
+
+    game.seed(7);
+    test.clear();
+    TEST_ASSERT_TRUE(test.newPiece());
+    TetrominoType held = test.type();
+    TEST_ASSERT_TRUE(test.hold());
+    TEST_ASSERT_FALSE(test.hold()); // once per tetromino
+    test.render();
+
+    // 2x1 pixels per block in the two rows above the board, only with hold in the rules
+    bool drawn[2][4] = {};
+    int pixels = 0;
+
+    for (int i = 0; i < 4; i++) {
+        drawn[-Pieces[held][ROTATION_0].blocks[i].y][Pieces[held][ROTATION_0].blocks[i].x + 1] = true;
+    }
+
+    for (int y = 0; y < 2; y++) {
+        for (int x = 1; x < PLAYSCREEN_WIDTH - 1; x++) {
+            bool expected = Rules::Hold::ENABLED && x >= LEFT_MARGIN && x < LEFT_MARGIN + 4 * HELD_BLOCK_WIDTH &&
+                drawn[y][(x - LEFT_MARGIN) / HELD_BLOCK_WIDTH];
+            TEST_ASSERT_EQUAL(expected, display.getPixel(x, y));
+            pixels += expected;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(Rules::Hold::ENABLED ? 8 : 0, pixels);
+    Native::clearTransmissions();
+}
+
+int main() {
+    s_Benchmark.generateCorpus();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_srs_kicks_match_the_offsets);
+    RUN_TEST(test_i_kicks_from_l_to_2);
+    RUN_TEST(test_plain_rotation_is_in_place);
+    RUN_TEST(test_plain_rotation_as_before_the_policies);
+    RUN_TEST(test_held_piece_is_drawn);
+
+    return UNITY_END();
+}
@@ -0,0 +1,224 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <Native.h>
+#include <unity.h>
+#include <vector>
+
+#include "sequencer.h"
+
+// the theme rendered to PCM, against the 5ms grid and against the timer driving the buzzer
+// set SEQUENCER_WAV to a file name to listen to it
+
+#define SAMPLE_RATE 44100 // Hz, not a multiple of the tick rate: a tick is 220.5 samples
+#define THEME_TICKS 1920 // one loop of the theme
+#define THEME_SAMPLES ((size_t)THEME_TICKS * SAMPLE_RATE * SEQUENCER_TICK / 1000)
+
+// the notes of the theme are quarters, eighths and dotted quarters, each one ends with a silent tick
+static const uint32_t NOTE_TICKS[] = { 59, 29, 89 };
+
+typedef struct {
+    size_t start; // sample
+    size_t length; // samples
+    uint32_t edges; // rising edges of the square wave
+} Run;
+
+static std::vector<uint8_t> s_Samples;
+static std::vector<Run> s_Notes; // the sounding runs, in order
+static uint32_t s_RenderNanoseconds;
+
+static void writeWav(const char* pPath, const std::vector<uint8_t>& samples) {
+    FILE* pFile = fopen(pPath, "wb");
+    TEST_ASSERT_NOT_NULL(pFile);
+
+    uint32_t dataSize = samples.size();
+    uint8_t header[44] = { 'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ', 16, 0, 0, 0,
+        1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 8, 0, 'd', 'a', 't', 'a', 0, 0, 0, 0 }; // PCM, mono, 8 bits
+
+    uint32_t fields[][2] = { {4, 36 + dataSize}, {24, SAMPLE_RATE}, {28, SAMPLE_RATE}, {40, dataSize} };
+
+    for (size_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+        for (int b = 0; b < 4; b++) {
+            header[fields[f][0] + b] = (fields[f][1] >> (8 * b)) & 0xFF;
+        }
+    }
+
+    fwrite(header, 1, sizeof(header), pFile);
+    fwrite(samples.data(), 1, samples.size(), pFile);
+    fclose(pFile);
+}
+
+// nearest tick boundary of a sample, -1 if it is more than a sample away from the grid
+static int32_t tickOf(size_t sample) {
+    int32_t tick = (int32_t)(((uint64_t)sample * 1000 + SAMPLE_RATE * SEQUENCER_TICK / 2) / (SAMPLE_RATE * SEQUENCER_TICK));
+    int64_t boundary = ((int64_t)tick * SAMPLE_RATE * SEQUENCER_TICK + 500) / 1000;
+
+    return (boundary - (int64_t)sample <= 1 && (int64_t)sample - boundary <= 1) ? tick : -1;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_render_needs_no_timer() {
+    Sequencer sequencer;
+    uint8_t samples[64];
+
+    TEST_ASSERT_TRUE(sequencer.render(samples, sizeof(samples), SAMPLE_RATE));
+
+    for (size_t i = 0; i < sizeof(samples); i++) {
+        TEST_ASSERT_EQUAL(128, samples[i]); // nothing posted, silence
+    }
+}
+
+void test_notes_on_tick_grid() {
+    TEST_ASSERT_GREATER_THAN(30, s_Notes.size());
+
+    for (size_t n = 0; n < s_Notes.size(); n++) {
+        int32_t start = tickOf(s_Notes[n].start);
+        int32_t end = tickOf(s_Notes[n].start + s_Notes[n].length);
+        char message[64];
+        snprintf(message, sizeof(message), "note %u at sample %u", (unsigned)n, (unsigned)s_Notes[n].start);
+
+        TEST_ASSERT_TRUE_MESSAGE(start >= 0 && end >= 0, message);
+
+        bool known = false;
+
+        for (size_t d = 0; d < sizeof(NOTE_TICKS) / sizeof(NOTE_TICKS[0]); d++) {
+            known = known || (uint32_t)(end - start) == NOTE_TICKS[d];
+        }
+
+        TEST_ASSERT_TRUE_MESSAGE(known, message);
+    }
+}
+
+void test_theme_loops_on_time() {
+    // the first note again after exactly one loop: no drift, whatever the length of a tick in samples
+    size_t loop = 0;
+
+    for (size_t n = 1; n < s_Notes.size() && loop == 0; n++) {
+        if (tickOf(s_Notes[n].start) == THEME_TICKS) {
+            loop = n;
+        }
+    }
+
+    TEST_ASSERT_GREATER_THAN(0, loop);
+    TEST_ASSERT_EQUAL(s_Notes[0].length, s_Notes[loop].length);
+    TEST_ASSERT_UINT32_WITHIN(1, s_Notes[0].edges, s_Notes[loop].edges);
+}
+
+void test_timer_plays_what_render_renders() {
+    Native::clearTones();
+
+    Sequencer sequencer;
+    TEST_ASSERT_TRUE(sequencer.begin());
+
+    uint8_t samples[16];
+    TEST_ASSERT_FALSE(sequencer.render(samples, sizeof(samples), SAMPLE_RATE)); // the timer owns the voices now
+
+    uint64_t start = Native::now();
+    sequencer.post(Sequencer::COMMAND_PLAY_MUSIC);
+    Native::advance((uint64_t)THEME_TICKS * SEQUENCER_TICK * 1000);
+
+    // tones alternate between a note and the silent tick that ends it (or a rest)
+    const std::vector<Native::Tone>& tones = Native::tones();
+    size_t note = 0;
+
+    for (size_t i = 1; i < tones.size() && note < s_Notes.size(); i++) {
+        if (tones[i].frequency == 0) {
+            continue;
+        }
+
+        const Run& run = s_Notes[note++];
+        double rendered = (double)run.edges * SAMPLE_RATE / run.length;
+        char message[64];
+        snprintf(message, sizeof(message), "note %u", (unsigned)(note - 1));
+
+        // same start, to the sample, and same pitch, to the resolution of a run of square waves
+        TEST_ASSERT_UINT32_WITHIN_MESSAGE(1000000 / SAMPLE_RATE + 1, (uint64_t)run.start * 1000000 / SAMPLE_RATE, tones[i].micros - start, message);
+        TEST_ASSERT_UINT32_WITHIN_MESSAGE(tones[i].frequency / 50 + 4, tones[i].frequency, (uint32_t)rendered, message);
+    }
+
+    TEST_ASSERT_GREATER_THAN(30, note);
+
+    // the timer only wakes up when the pitch changes, not every tick
+    TEST_ASSERT_LESS_THAN(THEME_TICKS / 10, sequencer.wakeups());
+}
+
+void test_render_speed() {
+    char message[80];
+    uint64_t audio = (uint64_t)THEME_SAMPLES * 1000000000 / SAMPLE_RATE; // nanoseconds
+
+    snprintf(message, sizeof(message), "render: %u ns per second of audio, %u ns per sample",
+        (unsigned)((uint64_t)s_RenderNanoseconds * 1000000000 / audio), (unsigned)(s_RenderNanoseconds / THEME_SAMPLES));
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_LESS_THAN(audio, s_RenderNanoseconds); // faster than real time, by far
+}
+
+int main() {
+    Native::useVirtualTime();
+
+    // a loop of the theme and the start of the next one
+    Sequencer sequencer;
+    sequencer.post(Sequencer::COMMAND_PLAY_MUSIC);
+    s_Samples.resize(THEME_SAMPLES + SAMPLE_RATE);
+
+    uint32_t startTime = ESP.getCycleCount();
+    sequencer.render(s_Samples.data(), s_Samples.size(), SAMPLE_RATE);
+    s_RenderNanoseconds = ESP.getCycleCount() - startTime;
+
+    for (size_t i = 0; i < s_Samples.size(); i++) {
+        bool sounding = s_Samples[i] != 128;
+
+        if (sounding && (s_Notes.empty() || s_Notes.back().start + s_Notes.back().length != i)) {
+            Run run = { i, 0, 0 };
+            s_Notes.push_back(run);
+        }
+
+        if (sounding) {
+            s_Notes.back().length++;
+            s_Notes.back().edges += (s_Samples[i] == 192 && (i == 0 || s_Samples[i - 1] != 192));
+        }
+    }
+
+    s_Notes.pop_back(); // cut by the end of the buffer
+
+    if (getenv("SEQUENCER_WAV") != NULL) {
+        writeWav(getenv("SEQUENCER_WAV"), s_Samples);
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_render_needs_no_timer);
+    RUN_TEST(test_notes_on_tick_grid);
+    RUN_TEST(test_theme_loops_on_time);
+    RUN_TEST(test_timer_plays_what_render_renders);
+    RUN_TEST(test_render_speed);
+
+    return UNITY_END();
+}
@@ -0,0 +1,309 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+
+#include "server.h"
+
+// the bot server protocol, driven through poll() with crafted byte streams
+
+// the requests written by the test, and the responses of the server
+class Pipe : public Stream {
+public:
+    Pipe() : m_Read(0) {}
+
+    void feed(const std::vector<uint8_t>& bytes) { m_Input.insert(m_Input.end(), bytes.begin(), bytes.end()); }
+
+    int available() override { return m_Input.size() - m_Read; }
+    int read() override { return (m_Read < m_Input.size()) ? m_Input[m_Read++] : -1; }
+    int peek() override { return (m_Read < m_Input.size()) ? m_Input[m_Read] : -1; }
+
+    size_t write(uint8_t c) override {
+        m_Output.push_back(c);
+        return 1;
+    }
+
+    size_t write(const uint8_t* pBuffer, size_t size) override {
+        m_Output.insert(m_Output.end(), pBuffer, pBuffer + size);
+        return size;
+    }
+
+    const std::vector<uint8_t>& output() const { return m_Output; }
+
+private:
+    std::vector<uint8_t> m_Input;
+    size_t m_Read;
+    std::vector<uint8_t> m_Output;
+};
+
+struct Response {
+    uint8_t type;
+    uint16_t sequence;
+    uint16_t count;
+    std::vector<uint8_t> states;
+
+    uint8_t status(int entry) const { return states[entry * SERVER_STATE_SIZE + 2]; }
+    uint8_t lines(int entry) const { return states[entry * SERVER_STATE_SIZE + 3]; }
+    uint8_t falling(int entry) const { return states[entry * SERVER_STATE_SIZE + 4]; }
+    const uint8_t* board(int entry) const { return &states[entry * SERVER_STATE_SIZE + 5 + PIECE_PREVIEW]; }
+};
+
+static uint8_t crc8(const uint8_t* pData, size_t length) {
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= pData[i];
+
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+
+    return crc;
+}
+
+static std::vector<uint8_t> request(uint8_t type, uint16_t sequence, uint16_t count, const std::vector<uint8_t>& entries) {
+    std::vector<uint8_t> bytes = {
+        SERVER_SYNC, type, (uint8_t)(sequence & 0xFF), (uint8_t)(sequence >> 8), (uint8_t)(count & 0xFF), (uint8_t)(count >> 8)
+    };
+
+    bytes.insert(bytes.end(), entries.begin(), entries.end());
+    bytes.push_back(crc8(&bytes[1], bytes.size() - 1));
+
+    return bytes;
+}
+
+static std::vector<uint8_t> resetEntry(uint16_t game, uint64_t seed) {
+    std::vector<uint8_t> entry = { (uint8_t)(game & 0xFF), (uint8_t)(game >> 8) };
+
+    for (int b = 0; b < 8; b++) {
+        entry.push_back((seed >> (8 * b)) & 0xFF);
+    }
+
+    return entry;
+}
+
+static std::vector<uint8_t> stepEntry(uint16_t game, uint8_t rotation, int8_t x) {
+    return { (uint8_t)(game & 0xFF), (uint8_t)(game >> 8), rotation, (uint8_t)x };
+}
+
+static std::vector<uint8_t> observeEntry(uint16_t game) {
+    return { (uint8_t)(game & 0xFF), (uint8_t)(game >> 8) };
+}
+
+// every response of the output, checked for framing and CRC
+static std::vector<Response> responses(const Pipe& pipe) {
+    const std::vector<uint8_t>& out = pipe.output();
+    std::vector<Response> result;
+    size_t pos = 0;
+
+    while (pos < out.size()) {
+        TEST_ASSERT_TRUE(out.size() - pos >= SERVER_HEADER_SIZE + 1);
+        TEST_ASSERT_EQUAL_HEX8(SERVER_SYNC, out[pos]);
+
+        Response response;
+        response.type = out[pos + 1];
+        response.sequence = out[pos + 2] | (out[pos + 3] << 8);
+        response.count = out[pos + 4] | (out[pos + 5] << 8);
+
+        size_t length = SERVER_HEADER_SIZE + response.count * SERVER_STATE_SIZE + 1;
+        TEST_ASSERT_TRUE(out.size() - pos >= length);
+        TEST_ASSERT_EQUAL_HEX8(crc8(&out[pos + 1], length - 2), out[pos + length - 1]);
+
+        response.states.assign(out.begin() + pos + SERVER_HEADER_SIZE, out.begin() + pos + length - 1);
+        result.push_back(response);
+        pos += length;
+    }
+
+    return result;
+}
+
+// polls until the server has read everything
+static void drain(GameServer* pServer, Pipe* pPipe) {
+    while (pPipe->available() > 0) {
+        pServer->poll();
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_crc_rejected() {
+    Pipe pipe;
+    GameServer server(&pipe);
+    TEST_ASSERT_TRUE(server.begin());
+
+    std::vector<uint8_t> bad = request(GameServer::REQUEST_OBSERVE, 1, 1, observeEntry(0));
+    bad.back() ^= 0x01;
+
+    // a corrupted request is skipped, with the noise around it, and the next one is answered
+    pipe.feed({ 0x00, 0xFF, SERVER_SYNC });
+    pipe.feed(bad);
+    pipe.feed(request(GameServer::REQUEST_OBSERVE, 2, 1, observeEntry(0)));
+    drain(&server, &pipe);
+
+    std::vector<Response> answered = responses(pipe);
+    TEST_ASSERT_EQUAL(1, answered.size());
+    TEST_ASSERT_EQUAL_HEX8(GameServer::REQUEST_OBSERVE | 0x80, answered[0].type);
+    TEST_ASSERT_EQUAL(2, answered[0].sequence);
+    TEST_ASSERT_EQUAL(GameServer::STATUS_OK, answered[0].status(0));
+}
+
+void test_pipelined_and_split_requests() {
+    Pipe pipe;
+    GameServer server(&pipe);
+    TEST_ASSERT_TRUE(server.begin());
+
+    // three requests in a single read, answered in order
+    std::vector<uint8_t> pipelined = request(GameServer::REQUEST_RESET, 10, 1, resetEntry(3, 42));
+    std::vector<uint8_t> step = request(GameServer::REQUEST_STEP, 11, 1, stepEntry(3, 0, 4));
+    std::vector<uint8_t> observe = request(GameServer::REQUEST_OBSERVE, 12, 1, observeEntry(3));
+    pipelined.insert(pipelined.end(), step.begin(), step.end());
+    pipelined.insert(pipelined.end(), observe.begin(), observe.end());
+    pipe.feed(pipelined);
+    drain(&server, &pipe);
+
+    std::vector<Response> answered = responses(pipe);
+    TEST_ASSERT_EQUAL(3, answered.size());
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(10 + i, answered[i].sequence);
+        TEST_ASSERT_EQUAL(1, answered[i].count);
+        TEST_ASSERT_EQUAL(GameServer::STATUS_OK, answered[i].status(0));
+    }
+
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&answered[1].states[0], &answered[2].states[0], SERVER_STATE_SIZE);
+
+    // the same request a byte at a time: nothing until the last byte
+    std::vector<uint8_t> split = request(GameServer::REQUEST_OBSERVE, 13, 1, observeEntry(3));
+
+    for (size_t i = 0; i < split.size(); i++) {
+        pipe.feed({ split[i] });
+        drain(&server, &pipe);
+        TEST_ASSERT_EQUAL((i + 1 < split.size()) ? 3 : 4, responses(pipe).size());
+    }
+
+    answered = responses(pipe);
+    TEST_ASSERT_EQUAL(13, answered[3].sequence);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&answered[2].states[0], &answered[3].states[0], SERVER_STATE_SIZE);
+}
+
+void test_illegal_placements() {
+    Pipe pipe;
+    GameServer server(&pipe);
+    TEST_ASSERT_TRUE(server.begin());
+
+    // a rotation out of range, columns off the board, the last column (every tetromino has a block
+    // right of its column in rotation 0), then a game out of range
+    std::vector<uint8_t> steps = stepEntry(0, ROTATION_COUNT, 4);
+    std::vector<uint8_t> entries[] = {
+        stepEntry(0, 0, -3), stepEntry(0, 0, BOARD_WIDTH + 2), stepEntry(0, 0, BOARD_WIDTH - 1), stepEntry(SERVER_GAMES, 0, 4)
+    };
+
+    for (const std::vector<uint8_t>& entry : entries) {
+        steps.insert(steps.end(), entry.begin(), entry.end());
+    }
+
+    pipe.feed(request(GameServer::REQUEST_RESET, 1, 1, resetEntry(0, 7)));
+    pipe.feed(request(GameServer::REQUEST_STEP, 2, 5, steps));
+    drain(&server, &pipe);
+
+    std::vector<Response> answered = responses(pipe);
+    TEST_ASSERT_EQUAL(2, answered.size());
+    TEST_ASSERT_EQUAL(5, answered[1].count);
+
+    // nothing changed: same falling tetromino, same empty board
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(GameServer::STATUS_INVALID_PLACEMENT, answered[1].status(i));
+        TEST_ASSERT_EQUAL(0, answered[1].lines(i));
+        TEST_ASSERT_EQUAL(answered[0].falling(0), answered[1].falling(i));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(answered[0].board(0), answered[1].board(i), PACKED_BOARD_SIZE);
+    }
+
+    TEST_ASSERT_EQUAL(GameServer::STATUS_INVALID_GAME, answered[1].status(4));
+}
+
+void test_batch_limits() {
+    Pipe pipe;
+    GameServer server(&pipe);
+    TEST_ASSERT_TRUE(server.begin());
+
+    // the largest request and the largest response
+    std::vector<uint8_t> resets;
+
+    for (int game = 0; game < SERVER_MAX_BATCH; game++) {
+        std::vector<uint8_t> entry = resetEntry(game, game);
+        resets.insert(resets.end(), entry.begin(), entry.end());
+    }
+
+    std::vector<uint8_t> largest = request(GameServer::REQUEST_RESET, 1, SERVER_MAX_BATCH, resets);
+    TEST_ASSERT_EQUAL(SERVER_MAX_REQUEST, largest.size());
+    pipe.feed(largest);
+    drain(&server, &pipe);
+
+    std::vector<Response> answered = responses(pipe);
+    TEST_ASSERT_EQUAL(1, answered.size());
+    TEST_ASSERT_EQUAL(SERVER_MAX_BATCH, answered[0].count);
+    TEST_ASSERT_EQUAL(SERVER_MAX_RESPONSE, pipe.output().size());
+
+    // one entry more is not a request
+    std::vector<uint8_t> observes;
+
+    for (int game = 0; game <= SERVER_MAX_BATCH; game++) {
+        std::vector<uint8_t> entry = observeEntry(game);
+        observes.insert(observes.end(), entry.begin(), entry.end());
+    }
+
+    pipe.feed(request(GameServer::REQUEST_OBSERVE, 2, SERVER_MAX_BATCH + 1, observes));
+    pipe.feed(request(GameServer::REQUEST_OBSERVE, 3, 1, observeEntry(0)));
+    drain(&server, &pipe);
+
+    answered = responses(pipe);
+    TEST_ASSERT_EQUAL(2, answered.size());
+    TEST_ASSERT_EQUAL(3, answered[1].sequence);
+
+    // an empty batch is still answered
+    pipe.feed(request(GameServer::REQUEST_OBSERVE, 4, 0, {}));
+    drain(&server, &pipe);
+
+    answered = responses(pipe);
+    TEST_ASSERT_EQUAL(3, answered.size());
+    TEST_ASSERT_EQUAL(0, answered[2].count);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_rejected);
+    RUN_TEST(test_pipelined_and_split_requests);
+    RUN_TEST(test_illegal_placements);
+    RUN_TEST(test_batch_limits);
+
+    return UNITY_END();
+}
@@ -0,0 +1,259 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <unity.h>
+#include <vector>
+
+#include "randomizer.h"
+#include "spectator.h"
+
+// the spectator stream decoded the way tools/spectator.py does it, against the framebuffers that were sent
+
+#define FRAMES 200
+
+// keeps each packet, with as much room in the transmit buffer as the test wants
+class Link : public Print {
+public:
+    Link() : m_Available(SPECTATOR_MAX_PACKET) {}
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* pBuffer, size_t size) override {
+        m_Packets.push_back(std::vector<uint8_t>(pBuffer, pBuffer + size));
+        return size;
+    }
+
+    int availableForWrite() override { return m_Available; }
+
+    void setAvailable(int available) { m_Available = available; }
+    const std::vector<std::vector<uint8_t>>& packets() const { return m_Packets; }
+
+private:
+    int m_Available;
+    std::vector<std::vector<uint8_t>> m_Packets;
+};
+
+static uint8_t crc8(const uint8_t* pData, size_t length) {
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= pData[i];
+
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+
+    return crc;
+}
+
+// applies a packet to the framebuffer of the viewer, false if it is malformed
+static bool decode(const std::vector<uint8_t>& packet, uint8_t* pFramebuffer) {
+    if (packet.size() < SPECTATOR_HEADER_SIZE + 1 || packet[0] != SPECTATOR_SYNC) {
+        return false;
+    }
+
+    size_t length = packet[4] | (packet[5] << 8);
+
+    if (packet.size() != SPECTATOR_HEADER_SIZE + length + 1 || crc8(&packet[1], packet.size() - 2) != packet.back()) {
+        return false;
+    }
+
+    if (packet[1] == Spectator::PACKET_KEYFRAME) {
+        memset(pFramebuffer, 0, SPECTATOR_FRAMEBUFFER_SIZE);
+    }
+
+    size_t pos = SPECTATOR_HEADER_SIZE;
+
+    for (int page = 0; page < SPECTATOR_PAGES; page++) {
+        if (!(packet[3] & (1 << page))) {
+            continue;
+        }
+
+        uint8_t* pPage = &pFramebuffer[page * SPECTATOR_PAGE_SIZE];
+        int i = 0;
+
+        while (i < SPECTATOR_PAGE_SIZE) {
+            uint8_t control = packet[pos++];
+            int count = (control & 0x7F) + 1;
+
+            if (i + count > SPECTATOR_PAGE_SIZE) {
+                return false;
+            }
+
+            for (int k = 0; k < count; k++) {
+                pPage[i++] ^= (control & 0x80) ? packet[pos] : packet[pos + k];
+            }
+
+            pos += (control & 0x80) ? 1 : count;
+        }
+    }
+
+    return pos == SPECTATOR_HEADER_SIZE + length;
+}
+
+// a few pixels of a falling piece and now and then a whole row, like the game screen
+static void change(uint8_t* pFramebuffer, RandomStream* pRandom) {
+    int pieces = 1 + pRandom->below(4);
+
+    for (int p = 0; p < pieces; p++) {
+        pFramebuffer[pRandom->below(SPECTATOR_FRAMEBUFFER_SIZE)] ^= 1 << pRandom->below(8);
+    }
+
+    if (pRandom->below(10) == 0) {
+        int page = pRandom->below(SPECTATOR_PAGES);
+
+        for (int i = 0; i < SPECTATOR_PAGE_SIZE; i++) {
+            pFramebuffer[page * SPECTATOR_PAGE_SIZE + i] = pRandom->next();
+        }
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_round_trip() {
+    Link link;
+    Spectator spectator(&link);
+    RandomStream random(7);
+    uint8_t framebuffer[SPECTATOR_FRAMEBUFFER_SIZE] = {};
+    uint8_t viewer[SPECTATOR_FRAMEBUFFER_SIZE];
+
+    for (int f = 0; f < FRAMES; f++) {
+        change(framebuffer, &random);
+        spectator.frame(framebuffer);
+
+        TEST_ASSERT_EQUAL(f + 1, link.packets().size());
+        TEST_ASSERT_TRUE(decode(link.packets().back(), viewer));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(framebuffer, viewer, SPECTATOR_FRAMEBUFFER_SIZE);
+        TEST_ASSERT_EQUAL(f & 0xFF, link.packets().back()[2]);
+    }
+
+    // the worst case fits: nothing repeats in a keyframe of noise
+    Spectator noisy(&link);
+
+    for (int i = 0; i < SPECTATOR_FRAMEBUFFER_SIZE; i++) {
+        framebuffer[i] = (i & 1) ? random.next() : i;
+    }
+
+    noisy.frame(framebuffer);
+    TEST_ASSERT_TRUE(link.packets().back().size() <= SPECTATOR_MAX_PACKET);
+    TEST_ASSERT_TRUE(decode(link.packets().back(), viewer));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(framebuffer, viewer, SPECTATOR_FRAMEBUFFER_SIZE);
+}
+
+void test_mask_covers_changed_pages() {
+    Link link;
+    Spectator spectator(&link);
+    uint8_t framebuffer[SPECTATOR_FRAMEBUFFER_SIZE] = {};
+
+    spectator.frame(framebuffer);
+    TEST_ASSERT_EQUAL(1, link.packets().size());
+    TEST_ASSERT_EQUAL(Spectator::PACKET_KEYFRAME, link.packets()[0][1]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, link.packets()[0][3]);
+
+    // nothing changed, nothing sent
+    spectator.frame(framebuffer);
+    TEST_ASSERT_EQUAL(1, link.packets().size());
+
+    framebuffer[2 * SPECTATOR_PAGE_SIZE + 5] = 0x18;
+    framebuffer[5 * SPECTATOR_PAGE_SIZE + SPECTATOR_PAGE_SIZE - 1] = 0x80;
+    spectator.frame(framebuffer);
+    TEST_ASSERT_EQUAL(2, link.packets().size());
+    TEST_ASSERT_EQUAL(Spectator::PACKET_DELTA, link.packets()[1][1]);
+    TEST_ASSERT_EQUAL_HEX8((1 << 2) | (1 << 5), link.packets()[1][3]);
+
+    framebuffer[2 * SPECTATOR_PAGE_SIZE + 5] = 0;
+    spectator.frame(framebuffer);
+    TEST_ASSERT_EQUAL_HEX8(1 << 2, link.packets()[2][3]);
+}
+
+void test_keyframe_interval() {
+    Link link;
+    Spectator spectator(&link);
+    RandomStream random(11);
+    uint8_t framebuffer[SPECTATOR_FRAMEBUFFER_SIZE] = {};
+
+    for (int f = 0; f < 3 * (SPECTATOR_KEYFRAME_INTERVAL + 1); f++) {
+        change(framebuffer, &random);
+        spectator.frame(framebuffer);
+    }
+
+    // a keyframe, then SPECTATOR_KEYFRAME_INTERVAL deltas
+    for (size_t p = 0; p < link.packets().size(); p++) {
+        uint8_t type = (p % (SPECTATOR_KEYFRAME_INTERVAL + 1) == 0) ? Spectator::PACKET_KEYFRAME : Spectator::PACKET_DELTA;
+        TEST_ASSERT_EQUAL(type, link.packets()[p][1]);
+    }
+}
+
+void test_busy_link_skips_frame() {
+    Link link;
+    Spectator spectator(&link);
+    RandomStream random(13);
+    uint8_t framebuffer[SPECTATOR_FRAMEBUFFER_SIZE] = {};
+    uint8_t viewer[SPECTATOR_FRAMEBUFFER_SIZE];
+
+    // a skipped keyframe is still owed
+    change(framebuffer, &random);
+    link.setAvailable(0);
+    spectator.frame(framebuffer);
+    TEST_ASSERT_EQUAL(0, link.packets().size());
+
+    link.setAvailable(SPECTATOR_MAX_PACKET);
+    change(framebuffer, &random);
+    spectator.frame(framebuffer);
+    TEST_ASSERT_EQUAL(1, link.packets().size());
+    TEST_ASSERT_EQUAL(Spectator::PACKET_KEYFRAME, link.packets()[0][1]);
+    TEST_ASSERT_TRUE(decode(link.packets()[0], viewer));
+
+    // a skipped delta: the next one carries its changes too, with the next frame number
+    for (int f = 0; f < 2; f++) {
+        change(framebuffer, &random);
+        link.setAvailable(f == 0 ? SPECTATOR_HEADER_SIZE : SPECTATOR_MAX_PACKET);
+        spectator.frame(framebuffer);
+    }
+
+    TEST_ASSERT_EQUAL(2, link.packets().size());
+    TEST_ASSERT_EQUAL(Spectator::PACKET_DELTA, link.packets()[1][1]);
+    TEST_ASSERT_EQUAL(1, link.packets()[1][2]);
+    TEST_ASSERT_TRUE(decode(link.packets()[1], viewer));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(framebuffer, viewer, SPECTATOR_FRAMEBUFFER_SIZE);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_mask_covers_changed_pages);
+    RUN_TEST(test_keyframe_interval);
+    RUN_TEST(test_busy_link_skips_frame);
+
+    return UNITY_END();
+}
@@ -0,0 +1,346 @@
+/*
+TETRIS for ESP32 with SSD1306 OLED display
+
+MIT License
+
+Copyright (c) 2025 Lorenzo Monti
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <Arduino.h>
+#include <Native.h>
+#include <unity.h>
+
+#include "link.h"
+#include "versus.h"
+#include "../game_test.h"
+
+// two units over an in-process link, on the virtual clock so the heartbeats go out on demand
+
+// the impaired match, with the latency and loss of the versus_loopback build
+#define IMPAIRED_DELAY 50 // milliseconds
+#define IMPAIRED_LOSS 10 // percent
+#define IMPAIRED_PIECES 400 // for each side
+#define IMPAIRED_PIECE_TIME 250 // milliseconds
+
+static NullRenderer s_Renderer;
+static Joystick s_Joystick;
+static Game s_GameA(&s_Joystick, &s_Renderer);
+static Game s_GameB(&s_Joystick, &s_Renderer);
+static LoopbackLink s_LinkA;
+static LoopbackLink s_LinkB;
+static Versus s_A(&s_LinkA, &s_GameA);
+static Versus s_B(&s_LinkB, &s_GameB);
+static GameTest s_TestA(&s_GameA);
+static GameTest s_TestB(&s_GameB);
+static RandomStream s_Moves(42);
+
+// a heartbeat each way, so both sides know the match of the other
+static void exchange() {
+    Native::advance(VERSUS_HEARTBEAT_PERIOD * 1000);
+    s_A.poll();
+    s_B.poll();
+    s_A.poll();
+}
+
+// one piece dropped at random, through the same steps as Game::playMatch
+static void playPiece(GameTest* pTest, Versus* pVersus) {
+    if (!pTest->newPiece()) {
+        // topped out: start over, the mirror of the opponent catches up with a resync
+        pTest->clear();
+        pTest->newPiece();
+    }
+
+    uint8_t rotation = s_Moves.below(ROTATION_COUNT);
+    int8_t target = s_Moves.below(BOARD_WIDTH);
+
+    for (uint8_t i = 0; i < rotation && pTest->rotate(); i++) {
+    }
+
+    while (pTest->x() < target && pTest->move(1)) {
+    }
+
+    while (pTest->x() > target && pTest->move(-1)) {
+    }
+
+    while (pTest->move(0, -1)) {
+    }
+
+    pTest->place();
+
+    uint8_t lines = 0;
+
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        bool full = true;
+
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            full = full && pTest->board()[i][j];
+        }
+
+        lines += full;
+    }
+
+    if (pTest->clearCompletedRows()) {
+        pTest->compactBoard();
+    }
+
+    uint8_t garbage = pVersus->takeGarbage();
+    uint8_t hole = s_Moves.below(BOARD_WIDTH);
+
+    if (garbage > 0) {
+        pTest->addGarbage(garbage, hole);
+    }
+
+    pVersus->pieceLocked(pTest->type(), pTest->rotation(), pTest->x(), pTest->y(), garbage, hole);
+    pVersus->linesCleared(lines);
+}
+
+static void assertMirror(const Game* pGame, const Versus* pMirror) {
+    uint8_t board[PACKED_BOARD_SIZE];
+    uint8_t mirror[PACKED_BOARD_SIZE];
+    pGame->packBoard(board);
+    pMirror->packMirror(mirror);
+
+    TEST_ASSERT_EQUAL_MEMORY(board, mirror, PACKED_BOARD_SIZE);
+}
+
+void setUp() {
+    s_TestA.clear();
+    s_TestB.clear();
+    s_A.reset();
+    s_B.reset();
+    exchange();
+}
+
+void tearDown() {
+    // whatever is still in flight is delivered now, not in the next test
+    s_LinkA.setImpairment(0, 0);
+    s_LinkB.setImpairment(0, 0);
+    Native::advance(VERSUS_HEARTBEAT_PERIOD * 1000);
+    s_A.poll();
+    s_B.poll();
+
+    while (s_A.takeGarbage() > 0) {
+    }
+
+    while (s_B.takeGarbage() > 0) {
+    }
+}
+
+void test_garbage_is_delivered() {
+    s_A.linesCleared(4);
+    s_B.poll();
+
+    TEST_ASSERT_EQUAL(4, s_B.takeGarbage());
+    TEST_ASSERT_EQUAL(0, s_B.takeGarbage());
+
+    // heartbeats repeat the running total, it is not counted twice
+    exchange();
+    s_B.poll();
+
+    TEST_ASSERT_EQUAL(0, s_B.takeGarbage());
+}
+
+void test_late_start_gets_no_old_garbage() {
+    s_A.linesCleared(4);
+    s_A.linesCleared(4);
+    s_B.poll();
+    TEST_ASSERT_EQUAL(4, s_B.takeGarbage());
+    TEST_ASSERT_EQUAL(4, s_B.takeGarbage());
+
+    // B restarts while A keeps playing: A's running total is from a match B is no longer in
+    s_B.reset();
+    Native::advance(VERSUS_HEARTBEAT_PERIOD * 1000);
+    s_A.poll();
+    s_B.poll();
+
+    TEST_ASSERT_EQUAL(0, s_B.takeGarbage());
+
+    // once A has seen the new match, its garbage counts from zero
+    s_A.poll();
+    s_A.linesCleared(2);
+    s_B.poll();
+
+    TEST_ASSERT_EQUAL(1, s_B.takeGarbage());
+}
+
+void test_rematch_garbage_counts_at_once() {
+    s_A.linesCleared(4);
+    s_A.linesCleared(4);
+    s_B.poll();
+    TEST_ASSERT_EQUAL(4, s_B.takeGarbage());
+    TEST_ASSERT_EQUAL(4, s_B.takeGarbage());
+
+    // B is back first, A still sends for the old match
+    s_B.reset();
+    s_A.linesCleared(3);
+    s_B.poll();
+
+    TEST_ASSERT_EQUAL(0, s_B.takeGarbage());
+
+    // then A joins the rematch: a single line counts, without waiting for the old total of 10
+    s_A.reset();
+    exchange();
+    s_A.linesCleared(2);
+    s_B.poll();
+
+    TEST_ASSERT_EQUAL(1, s_B.takeGarbage());
+}
+
+void test_old_match_topping_out_is_ignored() {
+    s_B.reset();
+    s_A.toppedOut(); // the end of the previous match, for A
+    s_B.poll();
+
+    TEST_ASSERT_FALSE(s_B.opponentToppedOut());
+
+    s_A.reset();
+    exchange();
+    s_A.toppedOut();
+    s_B.poll();
+
+    TEST_ASSERT_TRUE(s_B.opponentToppedOut());
+}
+
+void test_lost_lock_is_replayed_after_snapshot() {
+    for (int i = 0; i < 3; i++) {
+        playPiece(&s_TestA, &s_A);
+    }
+
+    s_B.poll();
+    assertMirror(&s_GameA, &s_B);
+    TEST_ASSERT_EQUAL(0, s_B.resyncs());
+
+    s_LinkA.setImpairment(0, 100);
+    playPiece(&s_TestA, &s_A); // lost
+    s_LinkA.setImpairment(0, 0);
+    playPiece(&s_TestA, &s_A);
+
+    s_B.poll(); // a gap in the locks: asks for a snapshot
+    TEST_ASSERT_EQUAL(1, s_B.resyncs());
+
+    s_A.poll(); // answers it
+    s_B.poll(); // rolls back to it and replays the locks since
+
+    assertMirror(&s_GameA, &s_B);
+}
+
+void test_diverged_mirror_is_rolled_back() {
+    for (int i = 0; i < 3; i++) {
+        playPiece(&s_TestA, &s_A);
+    }
+
+    s_B.poll();
+    assertMirror(&s_GameA, &s_B);
+
+    // the board changes without a lock message, only the checksum of the heartbeat can tell
+    s_TestA.board()[0][0] = !s_TestA.board()[0][0];
+    Native::advance(VERSUS_HEARTBEAT_PERIOD * 1000);
+    s_A.poll();
+    s_B.poll();
+    TEST_ASSERT_EQUAL(1, s_B.resyncs());
+
+    s_A.poll();
+    s_B.poll();
+
+    assertMirror(&s_GameA, &s_B);
+}
+
+void test_periodic_snapshot_repairs_without_requests() {
+    playPiece(&s_TestA, &s_A);
+    s_B.poll();
+
+    s_TestA.board()[0][0] = !s_TestA.board()[0][0];
+    s_LinkB.setImpairment(0, 100); // every resync request of B is lost
+
+    for (uint32_t elapsed = 0; elapsed <= VERSUS_SNAPSHOT_PERIOD; elapsed += VERSUS_HEARTBEAT_PERIOD) {
+        Native::advance(VERSUS_HEARTBEAT_PERIOD * 1000);
+        s_A.poll();
+        s_B.poll();
+    }
+
+    assertMirror(&s_GameA, &s_B);
+}
+
+// a match over a slow and lossy link: the mirrors must end up right, and the cost is reported
+void test_impaired_match() {
+    s_LinkA.setImpairment(IMPAIRED_DELAY, IMPAIRED_LOSS, 1);
+    s_LinkB.setImpairment(IMPAIRED_DELAY, IMPAIRED_LOSS, 2);
+
+    uint32_t sent = s_LinkA.bytesSent() + s_LinkB.bytesSent();
+    uint32_t resyncs = s_A.resyncs() + s_B.resyncs();
+
+    for (int i = 0; i < IMPAIRED_PIECES; i++) {
+        playPiece(&s_TestA, &s_A);
+        playPiece(&s_TestB, &s_B);
+
+        for (uint32_t t = 0; t < IMPAIRED_PIECE_TIME; t += IMPAIRED_DELAY) {
+            Native::advance(IMPAIRED_DELAY * 1000);
+            s_A.poll();
+            s_B.poll();
+        }
+    }
+
+    uint32_t bytesPerSecond = (s_LinkA.bytesSent() + s_LinkB.bytesSent() - sent) * 1000 / (IMPAIRED_PIECES * IMPAIRED_PIECE_TIME) / 2;
+    resyncs = s_A.resyncs() + s_B.resyncs() - resyncs;
+
+    // no more losses: whatever diverged is repaired within a heartbeat and a retry
+    s_LinkA.setImpairment(IMPAIRED_DELAY, 0);
+    s_LinkB.setImpairment(IMPAIRED_DELAY, 0);
+
+    for (uint32_t t = 0; t < 4 * VERSUS_HEARTBEAT_PERIOD; t += IMPAIRED_DELAY) {
+        Native::advance(IMPAIRED_DELAY * 1000);
+        s_A.poll();
+        s_B.poll();
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u B/s per unit, %u resyncs, max resync latency %u/%u ms",
+        bytesPerSecond, resyncs, s_A.maxResyncLatency(), s_B.maxResyncLatency());
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_TRUE(resyncs > 0);
+    assertMirror(&s_GameA, &s_B);
+    assertMirror(&s_GameB, &s_A);
+}
+
+int main() {
+    Native::useVirtualTime();
+
+    s_LinkA.connect(&s_LinkB);
+    s_LinkB.connect(&s_LinkA);
+    s_GameA.seed(1);
+    s_GameB.seed(2);
+
+    if (!s_A.begin() || !s_B.begin()) {
+        return 1;
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_garbage_is_delivered);
+    RUN_TEST(test_late_start_gets_no_old_garbage);
+    RUN_TEST(test_rematch_garbage_counts_at_once);
+    RUN_TEST(test_old_match_topping_out_is_ignored);
+    RUN_TEST(test_lost_lock_is_replayed_after_snapshot);
+    RUN_TEST(test_diverged_mirror_is_rolled_back);
+    RUN_TEST(test_periodic_snapshot_repairs_without_requests);
+    RUN_TEST(test_impaired_match);
+
+    return UNITY_END();
+}
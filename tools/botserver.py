@@ -0,0 +1,314 @@
+#!/usr/bin/env python3
+#
+# TETRIS for ESP32 with SSD1306 OLED display
+#
+# Client and load generator for the bot server (see include/server.h).
+# Drives the headless games of a unit built with the "server" environment over its
+# serial port (or a pty), or of the "botserver" daemon over a Unix or TCP socket,
+# with pipelined batches of requests.
+#
+# The load generator runs 1 to N simulated clients. Each client owns a batch of games
+# and always has one request in flight. On a serial port the clients share the port,
+# so N clients keep N requests in the pipeline. On a socket every client is a process
+# with a connection of its own, and the daemon serves the connections concurrently.
+# For every number of clients it reports the throughput and the latency percentiles.
+#
+# usage: botserver.py /dev/ttyUSB0 --clients 8 --batch 8 --seconds 5
+#        botserver.py unix:/tmp/tetris.sock --clients 8 --batch 64
+#        botserver.py localhost:7654 --clients 8 --batch 64
+#
+# MIT License - Copyright (c) 2025 Lorenzo Monti
+
+import argparse
+import multiprocessing
+import os
+import random
+import select
+import socket
+import struct
+import termios
+import time
+
+SYNC = 0x5A
+RESET = 1
+STEP = 2
+OBSERVE = 3
+RESPONSE = 0x80
+HEADER_SIZE = 6
+BOARD_WIDTH = 10
+BOARD_HEIGHT = 21
+PIECE_PREVIEW = 4
+PACKED_BOARD_SIZE = (BOARD_WIDTH * BOARD_HEIGHT + 7) // 8
+STATE_SIZE = 5 + PIECE_PREVIEW + PACKED_BOARD_SIZE
+MAX_GAMES = 64
+
+STATUS_OK = 0
+STATUS_TOPPED_OUT = 1
+STATUS_INVALID_GAME = 2
+STATUS_INVALID_PLACEMENT = 3
+
+
+def crc8_table():
+    table = []
+    for byte in range(256):
+        crc = byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+        table.append(crc)
+    return table
+
+
+CRC8_TABLE = crc8_table()
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc = CRC8_TABLE[crc ^ byte]
+    return crc
+
+
+class State:
+    def __init__(self, data):
+        self.game, self.status, self.lines, self.piece = struct.unpack_from("<HBBB", data)
+        self.preview = list(data[5:5 + PIECE_PREVIEW])
+        self.board = data[5 + PIECE_PREVIEW:STATE_SIZE]
+
+    def cell(self, x, y):
+        bit = y * BOARD_WIDTH + x
+        return bool(self.board[bit // 8] & (1 << (bit % 8)))
+
+
+class BotClient:
+    """Pipelined requests: send() returns at once, responses come back in order."""
+
+    def __init__(self, fd):
+        self.fd = fd
+        self.seq = 0
+        self.buffer = bytearray()
+        self.errors = 0
+
+    def send(self, kind, entries):
+        body = struct.pack("<BHH", kind, self.seq, len(entries)) + b"".join(entries)
+        packet = bytes([SYNC]) + body + bytes([crc8(body)])
+        view = memoryview(packet)
+        while view:
+            view = view[os.write(self.fd, view):]
+        seq = self.seq
+        self.seq = (self.seq + 1) & 0xFFFF
+        return seq
+
+    def reset(self, games, seed):
+        return self.send(RESET, [struct.pack("<HQ", game, seed) for game in games])
+
+    def step(self, moves):
+        return self.send(STEP, [struct.pack("<HBb", game, rotation, x) for game, rotation, x in moves])
+
+    def observe(self, games):
+        return self.send(OBSERVE, [struct.pack("<H", game) for game in games])
+
+    def receive(self, timeout=None):
+        """Returns (kind, seq, states) of the next response, None on timeout."""
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            response = self.parse()
+            if response is not None:
+                return response
+            wait = None if deadline is None else max(deadline - time.monotonic(), 0)
+            if not select.select([self.fd], [], [], wait)[0]:
+                return None
+            self.buffer += os.read(self.fd, 65536)
+
+    def parse(self):
+        while True:
+            start = self.buffer.find(bytes([SYNC]))
+            if start < 0:
+                self.buffer.clear()
+                return None
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER_SIZE:
+                return None
+            kind, seq, count = struct.unpack_from("<BHH", self.buffer, 1)
+            if not kind & RESPONSE or count > MAX_GAMES:
+                del self.buffer[:1]  # not a response, e.g. a log line
+                continue
+            length = HEADER_SIZE + count * STATE_SIZE + 1
+            if len(self.buffer) < length:
+                return None
+            packet = bytes(self.buffer[:length])
+            if crc8(packet[1:-1]) != packet[-1]:
+                self.errors += 1
+                del self.buffer[:1]
+                continue
+            del self.buffer[:length]
+            states = [State(packet[HEADER_SIZE + i * STATE_SIZE:]) for i in range(count)]
+            return kind & ~RESPONSE, seq, states
+
+
+class SimulatedClient:
+    """A bot that drops its pieces at random, on its own batch of games."""
+
+    def __init__(self, games, seed):
+        self.games = games
+        self.random = random.Random(seed)
+        self.topped_out = list(games)  # everything starts with a reset
+        self.latencies = []
+        self.steps = 0
+
+    def request(self, client):
+        if self.topped_out:
+            games, self.topped_out = self.topped_out, []
+            return client.reset(games, self.random.getrandbits(64))
+        moves = [(game, self.random.randrange(4), self.random.randrange(BOARD_WIDTH - 1)) for game in self.games]
+        return client.step(moves)
+
+    def answered(self, kind, states, latency):
+        self.latencies.append(latency)
+        if kind == STEP:
+            self.steps += len(states)
+        self.topped_out += [state.game for state in states if state.status == STATUS_TOPPED_OUT]
+
+
+def percentile(values, fraction):
+    values = sorted(values)
+    return values[min(int(len(values) * fraction), len(values) - 1)] if values else 0
+
+
+def report(clients, latencies, steps, elapsed):
+    print("%3d clients  %7.1f requests/s  %8.1f steps/s  latency p50 %6.2fms  p99 %6.2fms  max %6.2fms" % (
+        clients, len(latencies) / elapsed, steps / elapsed,
+        percentile(latencies, 0.5) * 1000, percentile(latencies, 0.99) * 1000, max(latencies) * 1000))
+
+
+def load(client, clients, batch, seconds):
+    simulated = [SimulatedClient(range(i * batch, (i + 1) * batch), i) for i in range(clients)]
+    inflight = {}  # seq: (client, time sent)
+    for bot in simulated:
+        inflight[bot.request(client)] = (bot, time.monotonic())
+
+    start = time.monotonic()
+    stop = start + seconds
+    while inflight:
+        response = client.receive(timeout=2)
+        if response is None:
+            raise SystemExit("no response from the server")
+        kind, seq, states = response
+        if seq not in inflight:
+            continue
+        bot, sent = inflight.pop(seq)
+        now = time.monotonic()
+        bot.answered(kind, states, now - sent)
+        if now < stop:
+            inflight[bot.request(client)] = (bot, now)  # one request in flight per client
+    elapsed = time.monotonic() - start
+
+    latencies = [latency for bot in simulated for latency in bot.latencies]
+    report(clients, latencies, sum(bot.steps for bot in simulated), elapsed)
+
+
+def is_socket(address):
+    return address.startswith("unix:") or (":" in address and not os.path.exists(address))
+
+
+def connect(address):
+    if address.startswith("unix:"):
+        connection = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        connection.connect(address[len("unix:"):])
+    else:
+        host, _, port = address.rpartition(":")
+        connection = socket.create_connection((host or "localhost", int(port)))
+        connection.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    return connection
+
+
+def run_connection(address, index, batch, seconds, barrier, results):
+    """One simulated client in a process of its own, on a connection of its own."""
+    connection = connect(address)
+    client = BotClient(connection.fileno())
+    bot = SimulatedClient(range(batch), index)  # the games of the connection, no one else plays them
+    barrier.wait()
+
+    start = time.monotonic()
+    stop = start + seconds
+    now = start
+    while now < stop:
+        seq = bot.request(client)
+        sent = time.monotonic()
+        while True:
+            response = client.receive(timeout=2)
+            if response is None:
+                raise SystemExit("no response from the server")
+            kind, answered, states = response
+            if answered == seq:
+                break
+        now = time.monotonic()
+        bot.answered(kind, states, now - sent)
+
+    results.put((bot.latencies, bot.steps, now - start, client.errors))
+    connection.close()
+
+
+def load_sockets(address, clients, batch, seconds):
+    barrier = multiprocessing.Barrier(clients)
+    results = multiprocessing.Queue()
+    processes = [multiprocessing.Process(target=run_connection, args=(address, i, batch, seconds, barrier, results))
+                 for i in range(clients)]
+    for process in processes:
+        process.start()
+
+    latencies, steps, elapsed, errors = [], 0, 0, 0
+    for _ in processes:
+        client_latencies, client_steps, client_elapsed, client_errors = results.get()
+        latencies += client_latencies
+        steps += client_steps
+        elapsed = max(elapsed, client_elapsed)
+        errors += client_errors
+    for process in processes:
+        process.join()
+
+    report(clients, latencies, steps, elapsed)
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="bot server client and load generator")
+    parser.add_argument("port", help="serial port or pty of the server, or unix:PATH or [HOST:]PORT of the daemon")
+    parser.add_argument("--baud", type=int, default=921600)
+    parser.add_argument("--clients", type=int, default=8, help="up to this many concurrent clients")
+    parser.add_argument("--batch", type=int, default=8, help="games per client, one move for each in every request")
+    parser.add_argument("--seconds", type=float, default=5, help="for each number of clients")
+    args = parser.parse_args()
+
+    if is_socket(args.port):
+        # every connection has games of its own
+        if args.batch > MAX_GAMES:
+            parser.error("batch must not exceed %d games" % MAX_GAMES)
+
+        errors = 0
+        for clients in range(1, args.clients + 1):
+            errors += load_sockets(args.port, clients, args.batch, args.seconds)
+        if errors:
+            print("%d corrupted responses" % errors)
+        return
+
+    if args.clients * args.batch > MAX_GAMES:
+        parser.error("clients x batch must not exceed %d games" % MAX_GAMES)
+
+    fd = os.open(args.port, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(fd):
+        attributes = termios.tcgetattr(fd)
+        attributes[0] = attributes[1] = attributes[3] = 0  # raw
+        attributes[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        speed = getattr(termios, "B%d" % args.baud)
+        attributes[4] = attributes[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attributes)
+
+    client = BotClient(fd)
+    for clients in range(1, args.clients + 1):
+        load(client, clients, args.batch, args.seconds)
+    if client.errors:
+        print("%d corrupted responses" % client.errors)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+#
+# TETRIS for ESP32 with SSD1306 OLED display
+#
+# Reader for the placement datasets of the "record" environment (see include/dataset.h).
+# The file is mapped with numpy.memmap, chunk by chunk as a structured array, so a
+# dataset larger than the memory can be sliced without reading it all.
+#
+# usage: dataset.py dataset.ttrd
+#        dataset.py dataset.ttrd --show 10
+#        dataset.py dataset.ttrd --npz dataset.npz
+#
+# MIT License - Copyright (c) 2025 Lorenzo Monti
+
+import argparse
+import os
+
+import numpy as np
+
+MAGIC = b"TTRD"
+VERSION = 2
+HEADER_SIZE = 10
+BOARD_WIDTH = 10
+BOARD_HEIGHT = 21
+PACKED_BOARD_SIZE = (BOARD_WIDTH * BOARD_HEIGHT + 7) // 8
+MOVE_SIZE = 3
+CHUNK_MARKER = 0x4B43
+PIECES = "IJLOSTZ"
+
+
+class Dataset:
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            header = f.read(HEADER_SIZE)
+        if len(header) < HEADER_SIZE or header[:4] != MAGIC:
+            raise ValueError("%s: not a dataset" % path)
+        if header[4] != VERSION or header[5] != BOARD_WIDTH or header[6] != BOARD_HEIGHT:
+            raise ValueError("%s: version %d, board %dx%d not supported" % (path, header[4], header[5], header[6]))
+        self.chunk_records = header[8] | (header[9] << 8)
+        self.chunk_dtype = np.dtype([
+            ("boards", "u1", (self.chunk_records, PACKED_BOARD_SIZE)),
+            ("moves", "u1", (self.chunk_records, MOVE_SIZE)),
+            ("count", "<u2"),
+            ("marker", "<u2"),
+        ])
+        # a chunk cut short at the end of the file is ignored
+        chunks = (os.path.getsize(path) - HEADER_SIZE) // self.chunk_dtype.itemsize
+        self.chunks = np.memmap(path, dtype=self.chunk_dtype, mode="r", offset=HEADER_SIZE, shape=(chunks,)) \
+            if chunks > 0 else np.zeros(0, dtype=self.chunk_dtype)
+        # a chunk without its marker was cut short by a power cut and padded: it holds no records
+        counts = np.where(self.chunks["marker"] == CHUNK_MARKER, np.minimum(self.chunks["count"], self.chunk_records), 0) \
+            if chunks > 0 else np.zeros(0, dtype=np.uint16)
+        self.used = np.arange(self.chunk_records)[None, :] < counts[:, None]  # the meaningful slots
+
+    def __len__(self):
+        return int(self.used.sum())
+
+    def packed_boards(self):
+        """The packed boards of every record, (records, PACKED_BOARD_SIZE) bytes."""
+        return self.chunks["boards"][self.used]
+
+    def boards(self, start=0, stop=None):
+        """Boards as booleans, (records, BOARD_HEIGHT, BOARD_WIDTH), row 0 at the bottom."""
+        packed = self.packed_boards()[start:stop]
+        bits = np.unpackbits(packed, axis=1, bitorder="little")[:, :BOARD_WIDTH * BOARD_HEIGHT]
+        return bits.reshape(-1, BOARD_HEIGHT, BOARD_WIDTH).astype(bool)
+
+    def moves(self):
+        """The moves of every record: piece, rotation, x, y and lines cleared."""
+        raw = self.chunks["moves"][self.used].astype(np.uint32)
+        move = raw[:, 0] | (raw[:, 1] << 8) | (raw[:, 2] << 16)
+        return {
+            "piece": (move & 0x07).astype(np.uint8),
+            "rotation": ((move >> 3) & 0x03).astype(np.uint8),
+            "x": ((move >> 5) & 0x0F).astype(np.uint8),
+            "y": ((move >> 9) & 0x1F).astype(np.uint8),
+            "lines": ((move >> 14) & 0x07).astype(np.uint8),
+        }
+
+
+def show(dataset, index):
+    board = dataset.boards(index, index + 1)[0]
+    moves = dataset.moves()
+    print("record %d: piece %s, rotation %d, x %d, y %d, %d lines" % (
+        index, PIECES[moves["piece"][index]], moves["rotation"][index], moves["x"][index],
+        moves["y"][index], moves["lines"][index]))
+    for row in reversed(board):
+        print("|" + "".join("#" if cell else "." for cell in row) + "|")
+    print("+" + "-" * BOARD_WIDTH + "+")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="placement dataset reader")
+    parser.add_argument("dataset", help="file recorded by the record environment")
+    parser.add_argument("--show", type=int, metavar="N", help="draw the board of record N")
+    parser.add_argument("--npz", metavar="FILE", help="save the unpacked boards and the moves to a .npz file")
+    args = parser.parse_args()
+
+    dataset = Dataset(args.dataset)
+    moves = dataset.moves()
+    print("%d records in %d chunks of %d" % (len(dataset), len(dataset.chunks), dataset.chunk_records))
+    if len(dataset) > 0:
+        pieces = np.bincount(moves["piece"], minlength=len(PIECES))
+        print("pieces " + " ".join("%s:%d" % (PIECES[i], pieces[i]) for i in range(len(PIECES))))
+        lines = np.bincount(moves["lines"], minlength=5)
+        print("lines  " + " ".join("%d:%d" % (i, lines[i]) for i in range(len(lines))))
+
+    if args.show is not None:
+        show(dataset, args.show)
+
+    if args.npz:
+        np.savez_compressed(args.npz, boards=dataset.boards(), **moves)
+
+
+if __name__ == "__main__":
+    main()
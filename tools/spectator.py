@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+#
+# TETRIS for ESP32 with SSD1306 OLED display
+#
+# Viewer for the spectator stream (see include/spectator.h).
+# Reads the stream from a serial port, a pty or a recorded file, and draws the
+# screen in the terminal. Anything that is not a valid packet (log lines...) is skipped.
+#
+# usage: spectator.py /dev/ttyUSB0
+#        spectator.py recording.bin --no-draw
+#
+# MIT License - Copyright (c) 2025 Lorenzo Monti
+
+import argparse
+import os
+import sys
+import termios
+
+SYNC = 0xA5
+KEYFRAME = 1
+DELTA = 2
+HEADER_SIZE = 6
+PAGES = 8
+PAGE_SIZE = 128
+SCREEN_WIDTH = 128
+SCREEN_HEIGHT = 64
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def decode_page(payload, pos):
+    page = bytearray()
+    while len(page) < PAGE_SIZE:
+        control = payload[pos]
+        pos += 1
+        if control & 0x80:
+            page += bytes([payload[pos]]) * ((control & 0x7F) + 1)
+            pos += 1
+        else:
+            page += payload[pos:pos + control + 1]
+            pos += control + 1
+    if len(page) != PAGE_SIZE:
+        raise ValueError("page overrun")
+    return page, pos
+
+
+class Decoder:
+    def __init__(self):
+        self.framebuffer = None  # None until the first keyframe, and after a lost frame
+        self.expected = None  # frame number of the next delta
+        self.buffer = bytearray()
+        self.frames = 0
+        self.keyframes = 0
+        self.bytes = 0
+        self.errors = 0
+        self.gaps = 0
+
+    def feed(self, data):
+        """Returns the number of frames completed by this data."""
+        self.buffer += data
+        completed = 0
+        while True:
+            start = self.buffer.find(bytes([SYNC]))
+            if start < 0:
+                self.buffer.clear()
+                return completed
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER_SIZE:
+                return completed
+            length = HEADER_SIZE + (self.buffer[4] | (self.buffer[5] << 8)) + 1
+            if self.buffer[1] not in (KEYFRAME, DELTA) or length > HEADER_SIZE + PAGES * (PAGE_SIZE + 1) + 1:
+                del self.buffer[:1]  # not a packet
+                continue
+            if len(self.buffer) < length:
+                return completed
+            packet = bytes(self.buffer[:length])
+            if crc8(packet[1:-1]) != packet[-1] or not self.apply(packet):
+                self.errors += 1
+                del self.buffer[:1]
+                continue
+            del self.buffer[:length]
+            self.bytes += length
+            completed += 1
+
+    def apply(self, packet):
+        kind, number, mask, payload = packet[1], packet[2], packet[3], packet[HEADER_SIZE:-1]
+        if kind == DELTA and self.framebuffer is not None and number != self.expected:
+            self.framebuffer = None  # a frame was lost, this delta is against a screen we don't have
+            self.gaps += 1
+        if kind == DELTA and self.framebuffer is None:
+            return True  # joined mid-stream or lost a frame, wait for a keyframe
+        framebuffer = bytearray(PAGES * PAGE_SIZE) if kind == KEYFRAME else bytearray(self.framebuffer)
+        pos = 0
+        try:
+            for page in range(PAGES):
+                if mask & (1 << page):
+                    delta, pos = decode_page(payload, pos)
+                    base = page * PAGE_SIZE
+                    for i in range(PAGE_SIZE):
+                        framebuffer[base + i] ^= delta[i]
+        except (IndexError, ValueError):
+            return False
+        if pos != len(payload):
+            return False
+        self.framebuffer = framebuffer
+        self.expected = (number + 1) & 0xFF
+        self.frames += 1
+        self.keyframes += kind == KEYFRAME
+        return True
+
+    def pixel(self, x, y):
+        return self.framebuffer[x + (y // 8) * SCREEN_WIDTH] & (1 << (y % 8))
+
+
+def draw(decoder, out):
+    # the game runs in portrait (setRotation(3)): logical x,y is physical y,63-x
+    lines = ["\x1b[H"]
+    for y in range(0, SCREEN_WIDTH, 2):
+        row = []
+        for x in range(SCREEN_HEIGHT):
+            top = decoder.pixel(y, SCREEN_HEIGHT - 1 - x)
+            bottom = decoder.pixel(y + 1, SCREEN_HEIGHT - 1 - x)
+            row.append("█" if top and bottom else "▀" if top else "▄" if bottom else " ")
+        lines.append("".join(row))
+    lines.append("frames %d  keyframes %d  %.1f bytes/frame  errors %d  gaps %d\x1b[J" % (
+        decoder.frames, decoder.keyframes, decoder.bytes / max(decoder.frames, 1), decoder.errors, decoder.gaps))
+    out.write("\r\n".join(lines))
+    out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="spectator stream viewer")
+    parser.add_argument("source", help="serial port, pty or recorded stream")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--no-draw", action="store_true", help="only print the statistics at the end")
+    args = parser.parse_args()
+
+    fd = os.open(args.source, os.O_RDONLY | os.O_NOCTTY)
+    if os.isatty(fd):
+        attributes = termios.tcgetattr(fd)
+        attributes[0] = attributes[1] = attributes[3] = 0  # raw
+        attributes[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        speed = getattr(termios, "B%d" % args.baud)
+        attributes[4] = attributes[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attributes)
+
+    decoder = Decoder()
+    try:
+        while True:
+            data = os.read(fd, 4096)
+            if not data:
+                break
+            if decoder.feed(data) and decoder.framebuffer is not None and not args.no_draw:
+                draw(decoder, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+    print("\nframes %d, keyframes %d, %.1f bytes per frame, %d errors, %d gaps" % (
+        decoder.frames, decoder.keyframes, decoder.bytes / max(decoder.frames, 1), decoder.errors, decoder.gaps))
+
+
+if __name__ == "__main__":
+    main()